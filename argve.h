@@ -28,8 +28,82 @@
  / * argve_option
  / * argve_state
  / * argve_type
+ /
+ / optional features:
+ / * ARGVE_H_WITH_ADAPTIVE
+ /   - argve_adaptive_init(adaptive, options, slots, size, warmup) -> bool
+ /   - argve_adaptive, argve_slot
+ / * ARGVE_H_WITH_BLOOM
+ /   - argve_bloom_init(bloom, options, memory, size) -> bool
+ /   - argve_bloom
+ / * ARGVE_H_WITH_KINDS
+ /   - argve_kind(argument) -> result_type
+ /   - argve_classify(arguments, kinds)
+ /   - argve_skip_text(state) -> count
+ / * ARGVE_H_WITH_PRESCAN
+ /   - argve_prescan(count, arguments, wanted, found) -> count
+ / * ARGVE_H_WITH_INDEX
+ /   - argve_index_init(index, options, names, shorts, size) -> bool
+ /   - argve_index, argve_name
+ / * ARGVE_H_WITH_HOOKS
+ /   - state.match_short, state.match_long (see tools/argvegen.c)
+ / * ARGVE_H_WITH_CHOICES
+ /   - argve_choices_init(choices, names, slots, size) -> bool
+ /   - argve_choices
+ / * ARGVE_H_WITH_PAIRS
+ /   - argve_pairs_init(pairs, memory, slots, size) -> bool
+ /   - argve_pairs_add(pairs, state) -> index
+ /   - argve_pairs, argve_pair
+ / * ARGVE_H_WITH_SUGGEST
+ /   - argve_suggest(options, name, found, size) -> count
+ /   - argve_suggestion
+ / * ARGVE_H_WITH_RUN
+ /   - argve_run(state, handlers, context) -> result_type
+ /   - argve_handlers, argve_handler
+ / * ARGVE_H_WITH_DFA (implied by ARGVE_H_ENGINE_DFA)
+ /   - argve_next_dfa(state) -> result_type
+ / * ARGVE_H_WITH_TOKENS
+ /   - argve_tokenize(state, arguments, tokens, size) -> count
+ /   - argve_retokenize(state, arguments, tokens, count, size, first) -> count
+ /   - argve_to_token(state, arguments, token)
+ /   - argve_from_token(state, arguments, token)
+ /   - argve_token
+ / * ARGVE_H_WITH_SNAPSHOT (implies ARGVE_H_WITH_TOKENS)
+ /   - argve_snapshot_save(state, arguments, buffer, size) -> size
+ /   - argve_snapshot_open(snapshot, state, arguments, data, size) -> bool
+ /   - argve_snapshot_next(snapshot, state) -> result_type
+ /   - argve_snapshot
+ / * ARGVE_H_WITH_BUILDER (implies ARGVE_H_WITH_TOKENS)
+ /   - argve_builder_init(builder, arguments, size, arena, capacity) -> bool
+ /   - argve_builder_append(builder, arguments, count) -> bool
+ /   - argve_builder_pack(builder, prefix, value) -> bool
+ /   - argve_builder_token(builder, arguments, token) -> bool
+ /   - argve_builder
+ / * ARGVE_H_WITH_MANY (implies ARGVE_H_WITH_INDEX and ARGVE_H_WITH_TOKENS)
+ /   - argve_parse_many(jobs, count, index, results, threads) -> count
+ /   - argve_job, argve_result
 \*/
 
+#if defined(ARGVE_H_WITH_MANY) && !defined(ARGVE_H_WITH_INDEX)
+#define ARGVE_H_WITH_INDEX
+#endif
+
+#if defined(ARGVE_H_WITH_MANY) && !defined(ARGVE_H_WITH_TOKENS)
+#define ARGVE_H_WITH_TOKENS
+#endif
+
+#if defined(ARGVE_H_WITH_BUILDER) && !defined(ARGVE_H_WITH_TOKENS)
+#define ARGVE_H_WITH_TOKENS
+#endif
+
+#if defined(ARGVE_H_WITH_SNAPSHOT) && !defined(ARGVE_H_WITH_TOKENS)
+#define ARGVE_H_WITH_TOKENS
+#endif
+
+#if defined(ARGVE_H_ENGINE_DFA) && !defined(ARGVE_H_WITH_DFA)
+#define ARGVE_H_WITH_DFA
+#endif
+
 #ifndef ARGVE_H_API
 #define ARGVE_H_API  /* static, __attribute__, __declspec, [[...]], etc. */
 #endif
@@ -38,6 +112,14 @@
 #include <stdio.h>
 #endif
 
+#if defined(ARGVE_H_WITH_INDEX) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef ARGVE_H_WITH_MANY
+#include <pthread.h>  /* link with -pthread */
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,7 +134,8 @@ typedef enum {
     ARGVE_ERR_DEF_LONG,   /* unrecognized long flag */
     ARGVE_ERR_ARG_SHORT,  /* missing argument for short flag */
     ARGVE_ERR_ARG_LONG,   /* missing/unneeded argument for long flag */
-    ARGVE_ERR_UNKNOWN     /* unknown error */
+    ARGVE_ERR_UNKNOWN,    /* unknown error */
+    ARGVE_ERR_CHOICE      /* argument out of the choices for the flag */
 } argve_type;
 
 typedef struct {
@@ -61,6 +144,198 @@ typedef struct {
     char *longopt;  /* NULL for dummy */
 } argve_option;
 
+#ifdef ARGVE_H_WITH_ADAPTIVE
+/*\
+ / Per-option hit counters for adaptive probe order of a linear table.
+ /
+ / The slots live in caller memory and are kept sorted by hit count, so the
+ / table itself is never mutated.  An option shadowed by an earlier option
+ / with the same short/long flag is never probed for that flag, so matching
+ / always yields the same option as the plain linear scan.
+\*/
+typedef struct {
+    unsigned long hits;  /* number of matches (halved at each reordering) */
+    int index;           /* position in the table of options */
+    int shadowed;        /* bit 0: short flag; bit 1: long flag */
+} argve_slot;
+
+typedef struct {
+    argve_option *options;  /* the table that the slots belong to */
+    argve_slot *slots;      /* probe order; one slot per option */
+    int count;              /* number of options */
+    unsigned long lookups;  /* number of lookups since the last reordering */
+    unsigned long warmup;   /* number of lookups between reorderings */
+} argve_adaptive;
+#endif /* ARGVE_H_WITH_ADAPTIVE */
+
+#ifdef ARGVE_H_WITH_BLOOM
+/*\
+ / Bloom filter of names of long flags for fast rejection of unknown ones.
+ /
+ / The bits live in caller memory.  A name is hashed together with its
+ / length, so most unknown flags are rejected after a single scan of the
+ / argument instead of a failed search through the whole table.
+\*/
+typedef struct {
+    argve_option *options;  /* the table that the filter is built from */
+    unsigned char *bits;    /* caller memory */
+    unsigned long mask;     /* number of bits minus 1; a power of 2 */
+} argve_bloom;
+#endif /* ARGVE_H_WITH_BLOOM */
+
+#ifdef ARGVE_H_WITH_INDEX
+/*\
+ / Structure-of-arrays view of a table of options for faster matching.
+ /
+ / Short flags are packed one byte each into words, so that 16 of them are
+ / compared at once with SSE2 or a word at a time otherwise, and long flags
+ / are stored along with their lengths.  All arrays live in caller memory.
+\*/
+typedef struct {
+    const char *name;      /* long flag, or NULL */
+    unsigned long length;  /* length of the long flag */
+} argve_name;
+
+typedef struct {
+    argve_option *options;  /* the table that the index is built from */
+    argve_name *names;      /* long flags of each option */
+    unsigned long *shorts;  /* short flags of each option, 0 for none */
+    int count;              /* number of options */
+} argve_index;
+
+/* number of words for packing <n> short flags */
+#define ARGVE_INDEX_WORDS(n) \
+    (((unsigned long)(n) + 15) / 16 * 16 / sizeof(unsigned long))
+
+/* fewest options for argve_next to use the index rather than linear scans,
+   which are as fast for smaller tables in make bench */
+#ifndef ARGVE_INDEX_MIN_SHORT
+#define ARGVE_INDEX_MIN_SHORT 64
+#endif
+#ifndef ARGVE_INDEX_MIN_LONG
+#define ARGVE_INDEX_MIN_LONG 12
+#endif
+#endif /* ARGVE_H_WITH_INDEX */
+
+#ifdef ARGVE_H_WITH_TOKENS
+/*\
+ / Position-independent record of the parser state after argve_next.
+ /
+ / Strings are kept as (index, offset) pairs into the original argv, so that
+ / tokens can be stored, copied and compared without the parser state.
+\*/
+typedef struct {
+    argve_type type;
+    int option;  /* index in the table of options, or -1 for NULL */
+    int arg;     /* index of the argument where the token starts */
+    int optoff;  /* offset of state->optstr in argv[arg], or -1 for NULL */
+    int value;   /* index of the argument holding state->argstr */
+    int valoff;  /* offset of state->argstr in argv[value], or -1 for NULL */
+    int next;    /* index of the next unprocessed argument */
+} argve_token;
+#endif /* ARGVE_H_WITH_TOKENS */
+
+#ifdef ARGVE_H_WITH_SNAPSHOT
+/*\
+ / Replay of tokens from a snapshot instead of parsing the arguments again.
+ /
+ / Hashing and checking the arguments costs about as much as parsing them
+ / with a few dozen options, so replay only pays off for larger tables.
+\*/
+typedef struct {
+    const unsigned char *data;  /* encoded tokens */
+    char **argv;                /* the arguments that the tokens refer to */
+    int argc;                   /* number of arguments */
+    int count;                  /* number of tokens */
+    int index;                  /* index of the next token to replay */
+} argve_snapshot;
+
+/* size of a snapshot of <n> tokens */
+#define ARGVE_SNAPSHOT_SIZE(n) (36 + 28 * (unsigned long)(n))
+#endif /* ARGVE_H_WITH_SNAPSHOT */
+
+#ifdef ARGVE_H_WITH_BUILDER
+/*\
+ / A NULL-terminated argv for a child process, e.g. for posix_spawn(3).
+ /
+ / Arguments forwarded unchanged are referenced by pointer, and rewritten
+ / ones are packed one after another into an arena.  Both the array and the
+ / arena are caller memory, so nothing is allocated per argument.
+\*/
+typedef struct {
+    char **argv;             /* the array being built, always terminated */
+    int argc;                /* number of arguments so far */
+    int size;                /* capacity of argv including the NULL */
+    char *arena;             /* storage of the rewritten arguments */
+    unsigned long used;      /* bytes used in the arena */
+    unsigned long capacity;  /* size of the arena */
+} argve_builder;
+#endif /* ARGVE_H_WITH_BUILDER */
+
+#ifdef ARGVE_H_WITH_MANY
+/*\
+ / An independent command line for argve_parse_many.
+\*/
+typedef struct {
+    char **argv;  /* arguments, without the name of the program */
+    int argc;     /* number of arguments */
+} argve_job;
+
+/*\
+ / The tokens of a job, in a slab of caller memory.
+\*/
+typedef struct {
+    argve_token *tokens;  /* slab for at most <size> tokens */
+    int size;             /* capacity of the slab */
+    int count;            /* number of tokens stored, or -1 if invalid */
+} argve_result;
+
+/* maximum number of threads of argve_parse_many */
+#define ARGVE_MANY_THREADS 64
+
+/* bytes that keep the data of each thread off the cache lines of others */
+#ifndef ARGVE_MANY_PADDING
+#define ARGVE_MANY_PADDING 64
+#endif
+#endif /* ARGVE_H_WITH_MANY */
+
+#ifdef ARGVE_H_WITH_CHOICES
+/*\
+ / A set of valid arguments for an option, hashed into caller memory.
+\*/
+typedef struct {
+    const char *const *names;  /* NULL-terminated list of choices */
+    int *slots;                /* open addressing into names, -1 if empty */
+    unsigned long mask;        /* number of slots - 1 */
+    int count;                 /* number of choices */
+} argve_choices;
+#endif /* ARGVE_H_WITH_CHOICES */
+
+#ifdef ARGVE_H_WITH_PAIRS
+/*\
+ / A key=value argument split in place, e.g. -Dname=value or --set a.b=1.
+ /
+ / The key is not terminated; the value is the rest of the argument.
+\*/
+typedef struct {
+    argve_option *option;  /* the flag that brought the pair last */
+    const char *key;       /* start of the key in the argument */
+    int keylen;            /* length of the key */
+    const char *value;     /* NULL for an argument without '=' */
+} argve_pair;
+
+/*\
+ / Pairs collected from many arguments, unique by key, in caller memory.
+\*/
+typedef struct {
+    argve_pair *pairs;   /* in order of the first appearance of each key */
+    int *slots;          /* open addressing into pairs, -1 if empty */
+    unsigned long mask;  /* number of slots - 1 */
+    int count;           /* number of pairs */
+    int size;            /* capacity of pairs */
+} argve_pairs;
+#endif /* ARGVE_H_WITH_PAIRS */
+
 typedef struct {
     argve_option *options;
     argve_option *option;
@@ -69,8 +344,61 @@ typedef struct {
     char **argv;   /* unprocessed arguments */
     int argc;      /* number of unprocessed arguments in argv */
     argve_type type;
+#ifdef ARGVE_H_WITH_ADAPTIVE
+    argve_adaptive *adaptive;  /* NULL or tracking the same options */
+#endif
+#ifdef ARGVE_H_WITH_BLOOM
+    argve_bloom *bloom;        /* NULL or built from the same options */
+#endif
+#ifdef ARGVE_H_WITH_KINDS
+    const unsigned char *kinds;  /* NULL or argve_kind of each in argv */
+#endif
+#ifdef ARGVE_H_WITH_INDEX
+    argve_index *index;        /* NULL or built from the same options */
+#endif
+#ifdef ARGVE_H_WITH_CHOICES
+    /* NULL or the choices of each option, NULL for any argument */
+    const argve_choices *const *choices;
+    int choice;  /* index of state->argstr in its choices, otherwise -1 */
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    const unsigned char *pairs;  /* NULL or nonzero for each key=value flag */
+    char *valstr;  /* -Dkey=<value>, NULL if no '=' */
+    int keylen;    /* -D<key>=value, length of the key, otherwise -1 */
+#endif
+#ifdef ARGVE_H_WITH_HOOKS
+    /* NULL or replacements of argve_match_short/long for the options */
+    argve_option * (*match_short)(const argve_option *opts, int c);
+    argve_option * (*match_long)(const argve_option *opts, const char *s);
+#endif
 } argve_state;
 
+#ifdef ARGVE_H_WITH_RUN
+/*\
+ / Callbacks of argve_run; returning nonzero stops it.
+ /
+ / Each option is identified by its dense index in the table of options, as
+ / in state->option - state->options.  <value> is state->argstr.
+\*/
+typedef int (*argve_handler)(void *context, char *value);
+
+typedef struct {
+    const argve_handler *options;  /* indexed like the table, or NULL */
+    argve_handler text;            /* positional arguments, or NULL */
+    int (*error)(void *context, argve_state *state);  /* NULL to stop */
+} argve_handlers;
+#endif /* ARGVE_H_WITH_RUN */
+
+#ifdef ARGVE_H_WITH_SUGGEST
+/*\
+ / A long option near an unknown flag, see argve_suggest.
+\*/
+typedef struct {
+    argve_option *option;
+    int distance;  /* edit distance between the names */
+} argve_suggestion;
+#endif /* ARGVE_H_WITH_SUGGEST */
+
 /*\
  / Return 1 if an error happened, otherwise return 0.
 \*/
@@ -84,11 +412,168 @@ int argve_error(argve_state *state)
 ;
 #endif /* ARGVE_H_WITH_IMPLEMENTATION */
 
+#ifdef ARGVE_H_WITH_SUGGEST
+/*\
+ / Find the long options nearest to an unknown flag by edit distance.
+ /
+ / <name> is the name of the flag, e.g. state->optstr, up to '=' if any.
+ / The Levenshtein distance to every long option is computed with Myers'
+ / bit-parallel algorithm, a word of bits per column for names no longer
+ / than a word.  Options whose length alone differs too much are skipped,
+ / and so is the rest of a name once it cannot get any nearer.  At most
+ / <size> options within a distance of len(<name>) / 3 + 1 are stored in
+ / <found>, nearest first and then in the order of the table.
+ /
+ / Return the number of suggestions stored.
+\*/
+ARGVE_H_API
+int argve_suggest(argve_option *opts, const char *name,
+                  argve_suggestion *found, int size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long peq[256], pv, mv, ph, mh, eq, xv, xh, last;
+    int i, j, m, n, bound, score, count = 0;
+    const char *p;
+
+    if (opts == NULL || name == NULL || found == NULL || size <= 0) {
+        return 0;
+    }
+    for (m = 0; name[m] != '\0' && name[m] != '='; m += 1) {
+        if (m == (int)(sizeof(unsigned long) * 8)) {
+            return 0;
+        }
+    }
+    if (m == 0) {
+        return 0;
+    }
+    for (i = 0; i < 256; i += 1) {
+        peq[i] = 0;
+    }
+    for (i = 0; i < m; i += 1) {
+        peq[(unsigned char)name[i]] |= 1UL << i;
+    }
+    last = 1UL << (m - 1);
+    bound = m / 3 + 1;
+    for (; opts->shortopt != 0 || opts->longopt != NULL; opts += 1) {
+        if ((p = opts->longopt) == NULL) {
+            continue;
+        }
+        for (n = 0; p[n] != '\0' && n - m <= bound; n += 1) {
+            /* nothing */
+        }
+        if (n - m > bound || m - n > bound) {
+            continue;
+        }
+        pv = ~0UL;
+        mv = 0;
+        score = m;
+        for (j = 0; j < n && score - (n - j) <= bound; j += 1) {
+            eq = peq[(unsigned char)p[j]];
+            xv = eq | mv;
+            xh = (((eq & pv) + pv) ^ pv) | eq;
+            ph = mv | ~(xh | pv);
+            mh = pv & xh;
+            if (ph & last) {
+                score += 1;
+            } else if (mh & last) {
+                score -= 1;
+            }
+            /* the top row of the matrix grows by 1 per column */
+            ph = (ph << 1) | 1;
+            mh = mh << 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+        if (j < n || score > bound) {
+            continue;
+        }
+        /* insertion into the nearest <size> so far */
+        for (i = count < size ? count++ : size; i > 0; i -= 1) {
+            if (found[i - 1].distance <= score) {
+                break;
+            }
+            if (i < size) {
+                found[i] = found[i - 1];
+            }
+        }
+        if (i < size) {
+            found[i].option = opts;
+            found[i].distance = score;
+        }
+        if (count == size) {
+            /* only nearer ones can get in */
+            bound = found[size - 1].distance - 1;
+        }
+    }
+    return count;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_SUGGEST */
+
 #ifndef ARGVE_H_FREESTANDING
+#if defined(ARGVE_H_WITH_CHOICES) && defined(ARGVE_H_WITH_IMPLEMENTATION)
+/*\
+ / Print ARGVE_ERR_CHOICE along with the valid choices.
+\*/
+static
+int argve_perror_choice(argve_state *state, const char *label, FILE *stream)
+{
+    const char *const *p;
+    const char *q;
+    int n, m;
+
+    /* the value is either the last argument or attached to the flag */
+    q = state->argstr == state->argv[-1] ? state->argv[-2] : state->argv[-1];
+    if (q[1] == '-') {
+        n = fprintf(stream, "%s" "invalid argument for --%s : %s (",
+                    label, state->option->longopt, state->argstr);
+    } else {
+        n = fprintf(stream, "%s" "invalid argument for -%c : %s (",
+                    label, state->optstr[0], state->argstr);
+    }
+    p = state->choices[state->option - state->options]->names;
+    for (; n >= 0 && *p != NULL; p += 1) {
+        m = fprintf(stream, p[1] != NULL ? "%s|" : "%s", *p);
+        n = m < 0 ? m : n + m;
+    }
+    m = n < 0 ? n : fprintf(stream, ")\n");
+    return m < 0 ? m : n + m;
+}
+#endif
+
+#if defined(ARGVE_H_WITH_SUGGEST) && defined(ARGVE_H_WITH_IMPLEMENTATION)
+/*\
+ / Print the nearest long option to an unknown flag after <n> characters of
+ / the error message, for --name and -name but not a cluster of short flags.
+\*/
+static
+int argve_perror_suggest(argve_state *state, const char *label,
+                         FILE *stream, int n)
+{
+    argve_suggestion found;
+    int m;
+
+    if (n < 0 || (state->type == ARGVE_ERR_DEF_SHORT
+                  && state->optstr != state->argv[-1] + 1)
+            || argve_suggest(state->options, state->optstr, &found, 1) == 0) {
+        return n;
+    }
+    m = fprintf(stream, "%s" "did you mean --%s?\n",
+                label, found.option->longopt);
+    return m < 0 ? m : n + m;
+}
+#endif
+
 /*\
  / Output a diagnostic message according to the parser state.
  /
- / Return the return value from fprintf(3).
+ / A suggestion (ARGVE_H_WITH_SUGGEST) or the valid choices
+ / (ARGVE_H_WITH_CHOICES) may take more than one call of fprintf(3).
+ /
+ / Return the total number of characters written, or a negative value if
+ / any output fails.
 \*/
 ARGVE_H_API
 int argve_perror(argve_state *state, const char *label, FILE *stream)
@@ -115,14 +600,30 @@ int argve_perror(argve_state *state, const char *label, FILE *stream)
     case ARGVE_ERR_DEF_SHORT:
         c = state->optstr[0];
         q = state->argv[-1];
+#ifdef ARGVE_H_WITH_SUGGEST
+        return argve_perror_suggest(state, label, stream, fprintf(
+                    stream, "%s" "unrecognized option -%c : %s\n",
+                    label, c, q));
+#else
         return fprintf(stream, "%s" "unrecognized option -%c : %s\n",
                        label, c, q);
+#endif
     case ARGVE_ERR_DEF_LONG:
         q = state->argv[-1];
         p = q;
         while (*p && *p != '=') p += 1;
+#ifdef ARGVE_H_WITH_SUGGEST
+        return argve_perror_suggest(state, label, stream, fprintf(
+                    stream, "%s" "unrecognized option %.*s : %s\n",
+                    label, (int)(p - q), q, q));
+#else
         return fprintf(stream, "%s" "unrecognized option %.*s : %s\n",
                        label, (int)(p - q), q, q);
+#endif
+#ifdef ARGVE_H_WITH_CHOICES
+    case ARGVE_ERR_CHOICE:
+        return argve_perror_choice(state, label, stream);
+#endif
     case ARGVE_ERR_UNKNOWN:
         goto error;
     default:
@@ -145,7 +646,71 @@ void argve_advance(argve_state *state)
 {
     state->argc -= 1;
     state->argv += 1;
+#ifdef ARGVE_H_WITH_KINDS
+    if (state->kinds != NULL) {
+        state->kinds += 1;
+    }
+#endif
+}
+
+/*\
+ / Return 1 if there are more flags to process in a cluster of short flags.
+\*/
+static
+int argve_in_cluster(const argve_state *state)
+{
+    return state->type == ARGVE_CLUSTER
+        && state->argstr == NULL && state->optstr[1] != '\0';
+}
+
+#ifdef ARGVE_H_WITH_KINDS
+/*\
+ / Classify an argument by its first three bytes without branching.
+ /
+ / Return ARGVE_SHORT for "-?*" except "--*", ARGVE_LONG for "--?*",
+ / otherwise ARGVE_TEXT for positional arguments including "--" and "-".
+ / Bytes after the terminating NUL are never read.
+\*/
+static
+argve_type argve_kind(const char *arg)
+{
+    int dash = arg[0] == '-';
+    int c1 = arg[dash];
+    int c2 = arg[dash + (dash & (c1 != '\0'))];
+    int is_short = dash & (c1 != '-') & (c1 != '\0');
+    int is_long = dash & (c1 == '-') & (c2 != '\0');
+
+    return (argve_type)(ARGVE_TEXT + is_short * (ARGVE_SHORT - ARGVE_TEXT)
+                                   + is_long * (ARGVE_LONG - ARGVE_TEXT));
+}
+#endif
+
+#ifndef ARGVE_H_ENGINE_DFA
+/*\
+ / Classify the next argument for argve_next, from state->kinds if attached.
+ /
+ / Return ARGVE_SHORT, ARGVE_LONG or ARGVE_TEXT as argve_kind does.
+\*/
+static
+argve_type argve_next_kind(const argve_state *state)
+{
+    const char *arg = state->argv[0];
+
+#ifdef ARGVE_H_WITH_KINDS
+    if (state->kinds != NULL) {
+        return (argve_type)state->kinds[0];
+    }
+    return argve_kind(arg);
+#else
+    if (arg[0] == '-' && arg[1] != '-' && arg[1] != '\0') {
+        return ARGVE_SHORT;
+    } else if (arg[0] == '-' && arg[1] == '-' && arg[2] != '\0') {
+        return ARGVE_LONG;
+    }
+    return ARGVE_TEXT;
+#endif
 }
+#endif
 
 /*\
  / Return 1 if there is the end of options, otherwise return 0.
@@ -228,6 +793,21 @@ char * argve_to_long_opt(const char *s, int search)
     return NULL;
 }
 
+/*\
+ / Return 1 if the long flag <p> is the name in <s> "<name>[=<value>]".
+\*/
+static
+int argve_match_name(const char *p, const char *s)
+{
+    if (p != NULL && *p) {
+        while (*p && *s && *p == *s) {
+            p += 1; s += 1;
+        }
+        return *p == '\0' && (*s == '\0' || *s == '=');
+    }
+    return 0;
+}
+
 /*\
  / Find the long option with name in string <s> "--<name>[=<value>]".
  /
@@ -237,209 +817,2158 @@ char * argve_to_long_opt(const char *s, int search)
 static
 argve_option * argve_match_long(const argve_option *opts, const char *s)
 {
-    const char *p, *q;
-
     if (opts == NULL || (s = argve_to_long_opt(s, 1)) == NULL) {
         return NULL;
     }
     while (!argve_option_end(opts)) {
-        if ((p = opts->longopt) != NULL && *p) {
-            q = s;
-            while (*p && *q && *p == *q) {
-                p += 1; q += 1;
-            }
-            if (*p == '\0' && (*q == '\0' || *q == '=')) {
-                return (argve_option *)opts;
-            }
+        if (argve_match_name(opts->longopt, s)) {
+            return (argve_option *)opts;
         }
         opts += 1;
     }
     return NULL;
 }
-#endif /* ARGVE_H_WITH_IMPLEMENTATION */
 
-/* Parse the next argument.
- /
- / If a cluster of short flags is found in an argument string "-<chars>",
- /     state->optstr is the start of each single-character option name,
- /     state->argstr is NULL, the remaining <chars> or the next argument;
- /
- / If a short flag is found in an argument string "-o[<value>]",
- /     state->optstr is the start of the single-character option name,
- /     state->argstr is either NULL, <value> or the next argument string;
- /
- / If a long flag is found in an argument string "--name[=<value>]",
- /     state->optstr is the start of the option name,
- /     state->argstr is either NULL, <value> or the next argument string;
- /
- / If an error happens,
- /     state->optstr points to undefined option name,
- /     state->argstr is <value> for --name=<value> where <value> is unneeded,
- /     stop processing the current argument,
- /     report the error and prepare to handle the next argument as normal;
+#ifdef ARGVE_H_WITH_ADAPTIVE
+/*\
+ / Count a lookup and refresh the probe order after every <warmup> lookups.
  /
- / Otherwise, the next argument is a positional argument.
+ / Slots are sorted by hit count in descending order with insertion sort,
+ / which is stable and nearly linear once the order has converged.  Counters
+ / are halved afterwards so that the order keeps following recent usage.
 \*/
-ARGVE_H_API
-argve_type argve_next(argve_state *state)
-#ifdef ARGVE_H_WITH_IMPLEMENTATION
+static
+void argve_adaptive_tick(argve_adaptive *adaptive)
 {
-    int c; char *arg;
+    argve_slot slot, *slots = adaptive->slots;
+    int i, j;
 
-    /* parse cluster of short flags */
-    if (state->type == ARGVE_CLUSTER
-            && state->argstr == NULL && state->optstr[1] != '\0') {
-        /* process the next flag; -abc => -bc */
-        state->optstr += 1;
-        state->argstr = NULL;
-        c = argve_to_short_opt(state->optstr[0]);
-        state->option = argve_match_short(state->options, c);
-        if (state->option != NULL) {
-            /*state->type = ARGVE_CLUSTER;*/
-            if (state->option->need_arg) {
-                if (state->optstr[1] != '\0') {
-                    /* -o<value> */
-                    state->argstr = state->optstr + 1;
-                } else if (state->argc > 0) {
-                    /* -o <value> */
-                    state->argstr = state->argv[0];
-                    argve_advance(state);
-                } else {
-                    state->type = ARGVE_ERR_ARG_SHORT;
-                }
-            }
-        } else {
-            state->type = ARGVE_ERR_DEF_SHORT;
+    if (adaptive->warmup == 0 || ++adaptive->lookups < adaptive->warmup) {
+        return;
+    }
+    adaptive->lookups = 0;
+    for (i = 1; i < adaptive->count; i += 1) {
+        slot = slots[i];
+        for (j = i; j > 0 && slots[j - 1].hits < slot.hits; j -= 1) {
+            slots[j] = slots[j - 1];
         }
-        return state->type;
+        slots[j] = slot;
+    }
+    for (i = 0; i < adaptive->count; i += 1) {
+        slots[i].hits >>= 1;
     }
+}
 
-    /* parse new argument */
-    if (state->argc > 0) {
-        state->type = ARGVE_ERR_UNKNOWN;
-        state->option = NULL;
-        state->optstr = NULL;
+/*\
+ / Same as argve_match_short but probing options in adaptive order.
+\*/
+static
+argve_option * argve_adaptive_short(argve_adaptive *adaptive, int c)
+{
+    argve_slot *slot = adaptive->slots, *end = slot + adaptive->count;
+    argve_option *opt = NULL;
+
+    if (c != 0) {
+        for (; slot < end; slot += 1) {
+            if (!(slot->shadowed & 1)
+                    && adaptive->options[slot->index].shortopt == c) {
+                opt = &adaptive->options[slot->index];
+                slot->hits += 1;
+                break;
+            }
+        }
+    }
+    argve_adaptive_tick(adaptive);
+    return opt;
+}
+
+/*\
+ / Same as argve_match_long but probing options in adaptive order.
+\*/
+static
+argve_option * argve_adaptive_long(argve_adaptive *adaptive, const char *s)
+{
+    argve_slot *slot = adaptive->slots, *end = slot + adaptive->count;
+    argve_option *opt = NULL;
+
+    if ((s = argve_to_long_opt(s, 1)) != NULL) {
+        for (; slot < end; slot += 1) {
+            if (!(slot->shadowed & 2) && argve_match_name(
+                        adaptive->options[slot->index].longopt, s)) {
+                opt = &adaptive->options[slot->index];
+                slot->hits += 1;
+                break;
+            }
+        }
+    }
+    argve_adaptive_tick(adaptive);
+    return opt;
+}
+#endif /* ARGVE_H_WITH_ADAPTIVE */
+
+#ifdef ARGVE_H_WITH_BLOOM
+/*\
+ / Hash the name in <s> "<name>[=<value>]" along with its length.
+ /
+ / This is 32-bit FNV-1a with the length folded in at the end.
+\*/
+static
+unsigned long argve_bloom_hash(const char *s)
+{
+    unsigned long h = 2166136261UL, n = 0;
+
+    while (s[n] != '\0' && s[n] != '=') {
+        h = ((h ^ (unsigned char)s[n]) * 16777619UL) & 0xFFFFFFFFUL;
+        n += 1;
+    }
+    return ((h ^ n) * 16777619UL) & 0xFFFFFFFFUL;
+}
+
+/*\
+ / Return 0 if the name in <s> "<name>[=<value>]" is surely not in <bloom>.
+ /
+ / Two bits are probed, derived from the two halves of the hash.
+\*/
+static
+int argve_bloom_test(const argve_bloom *bloom, const char *s)
+{
+    unsigned long h = argve_bloom_hash(s);
+    unsigned long a = h & bloom->mask;
+    unsigned long b = ((h >> 16) | (h << 16)) & bloom->mask;
+
+    return (bloom->bits[a >> 3] >> (a & 7) & 1)
+        && (bloom->bits[b >> 3] >> (b & 7) & 1);
+}
+#endif /* ARGVE_H_WITH_BLOOM */
+
+#ifdef ARGVE_H_WITH_INDEX
+/*\
+ / Same as argve_match_short but searching the packed short flags.
+ /
+ / A padding byte or an option without a proper short flag is 0, which never
+ / equals <c>, so the first equal byte is always the option to find.
+\*/
+static
+argve_option * argve_index_short(const argve_index *index, int c)
+{
+    const unsigned long *p = index->shorts;
+    unsigned long n = ARGVE_INDEX_WORDS(index->count), i;
+#ifdef __SSE2__
+    __m128i key = _mm_set1_epi8((char)c);
+    int mask;
+
+    if (c == 0) {
+        return NULL;
+    }
+    for (i = 0; i < n; i += 16 / sizeof(unsigned long)) {
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+                    key, _mm_loadu_si128((const __m128i *)(p + i))));
+        if (mask != 0) {
+            n = i * sizeof(unsigned long);
+            while (!(mask & 1)) {
+                mask >>= 1; n += 1;
+            }
+            return index->options + n;
+        }
+    }
+#else
+    unsigned long ones = ~0UL / 0xFF, x;
+
+    if (c == 0) {
+        return NULL;
+    }
+    for (i = 0; i < n; i += 1) {
+        /* the lowest flagged byte is always a zero byte of x */
+        x = p[i] ^ (ones * (unsigned long)c);
+        x = (x - ones) & ~x & (ones << 7);
+        if (x != 0) {
+            n = i * sizeof(unsigned long);
+            while (!(x & 0x80)) {
+                x >>= 8; n += 1;
+            }
+            return index->options + n;
+        }
+    }
+#endif
+    return NULL;
+}
+
+/*\
+ / Same as argve_match_long but comparing lengths of names first.
+\*/
+static
+argve_option * argve_index_long(const argve_index *index, const char *s)
+{
+    const argve_name *p = index->names, *end = p + index->count;
+    unsigned long n = 0, i;
+
+    if ((s = argve_to_long_opt(s, 1)) == NULL) {
+        return NULL;
+    }
+    while (s[n] != '\0' && s[n] != '=') {
+        n += 1;
+    }
+    for (; p < end; p += 1) {
+        if (p->length == n && p->name[0] == s[0]) {
+            for (i = 1; i < n && p->name[i] == s[i]; i += 1) {
+                /* nothing */
+            }
+            if (i == n) {
+                return index->options + (p - index->names);
+            }
+        }
+    }
+    return NULL;
+}
+#endif /* ARGVE_H_WITH_INDEX */
+
+/*\
+ / Find the short option for argve_next using the fastest matcher available.
+\*/
+static
+argve_option * argve_lookup_short(argve_state *state, int c)
+{
+#ifdef ARGVE_H_WITH_HOOKS
+    if (state->match_short != NULL) {
+        return state->match_short(state->options, c);
+    }
+#endif
+#ifdef ARGVE_H_WITH_INDEX
+    if (state->index != NULL && state->index->options == state->options
+            && state->index->count >= ARGVE_INDEX_MIN_SHORT) {
+        return argve_index_short(state->index, c);
+    }
+#endif
+#ifdef ARGVE_H_WITH_ADAPTIVE
+    if (state->adaptive != NULL
+            && state->adaptive->options == state->options) {
+        return argve_adaptive_short(state->adaptive, c);
+    }
+#endif
+    return argve_match_short(state->options, c);
+}
+
+/*\
+ / Find the long option for argve_next using the fastest matcher available.
+\*/
+static
+argve_option * argve_lookup_long(argve_state *state, const char *s)
+{
+#ifdef ARGVE_H_WITH_BLOOM
+    /* argve_next only looks up arguments like "--?*" */
+    if (state->bloom != NULL && state->bloom->options == state->options
+            && !argve_bloom_test(state->bloom, s + 2)) {
+        return NULL;
+    }
+#endif
+#ifdef ARGVE_H_WITH_HOOKS
+    if (state->match_long != NULL) {
+        return state->match_long(state->options, s);
+    }
+#endif
+#ifdef ARGVE_H_WITH_INDEX
+    if (state->index != NULL && state->index->options == state->options
+            && state->index->count >= ARGVE_INDEX_MIN_LONG) {
+        return argve_index_long(state->index, s);
+    }
+#endif
+#ifdef ARGVE_H_WITH_ADAPTIVE
+    if (state->adaptive != NULL
+            && state->adaptive->options == state->options) {
+        return argve_adaptive_long(state->adaptive, s);
+    }
+#endif
+    return argve_match_long(state->options, s);
+}
+
+#ifdef ARGVE_H_WITH_CHOICES
+/*\
+ / Hash a string with 32-bit FNV-1a.
+\*/
+static
+unsigned long argve_choice_hash(const char *s)
+{
+    unsigned long h = 2166136261UL;
+
+    for (; *s != '\0'; s += 1) {
+        h = ((h ^ (unsigned char)*s) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return h;
+}
+
+/*\
+ / Find <s> in <choices>; return its index, otherwise return -1.
+\*/
+static
+int argve_choice_find(const argve_choices *choices, const char *s)
+{
+    unsigned long h = argve_choice_hash(s);
+    const char *p, *q;
+    int i;
+
+    for (;; h += 1) {
+        if ((i = choices->slots[h & choices->mask]) < 0) {
+            return -1;
+        }
+        for (p = s, q = choices->names[i]; *p != '\0' && *p == *q; p += 1) {
+            q += 1;
+        }
+        if (*p == *q) {
+            return i;
+        }
+    }
+}
+
+/*\
+ / Resolve the argument of a flag to the index of a choice for argve_next.
+\*/
+static
+void argve_choose(argve_state *state)
+{
+    const argve_choices *choices;
+
+    state->choice = -1;
+    if (state->choices != NULL && state->argstr != NULL
+            && state->option != NULL && !argve_error(state)) {
+        choices = state->choices[state->option - state->options];
+        if (choices != NULL) {
+            state->choice = argve_choice_find(choices, state->argstr);
+            if (state->choice < 0) {
+                state->type = ARGVE_ERR_CHOICE;
+            }
+        }
+    }
+}
+#endif /* ARGVE_H_WITH_CHOICES */
+
+#ifdef ARGVE_H_WITH_PAIRS
+/*\
+ / Split the argument of a key=value flag at the first '=' for argve_next.
+ /
+ / The engines stop scanning at the '=' after the name of a long flag, so
+ / the key is scanned once from state->argstr and nothing is copied.
+\*/
+static
+void argve_split(argve_state *state)
+{
+    char *p;
+
+    state->valstr = NULL;
+    state->keylen = -1;
+    if (state->pairs != NULL && state->argstr != NULL
+            && state->option != NULL && !argve_error(state)
+            && state->pairs[state->option - state->options]) {
+        for (p = state->argstr; *p != '\0' && *p != '='; p += 1) {
+            /* nothing */
+        }
+        state->keylen = (int)(p - state->argstr);
+        state->valstr = *p != '\0' ? p + 1 : NULL;
+    }
+}
+#endif /* ARGVE_H_WITH_PAIRS */
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+#ifdef ARGVE_H_WITH_DFA
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+/*\
+ / States and actions of the table-driven engine, see argve_next_dfa.
+ /
+ / A state consumes one byte of its class and moves to the next state, until
+ / it ends up with an action.  The actions from ARGVE_DFA_DONE on resolve the
+ / value of a matched flag, indexed by need_arg, whether there are bytes left
+ / in the argument, and whether there are arguments left.
+\*/
+enum {
+    ARGVE_DFA_START = 0,  /* the first byte of an argument */
+    ARGVE_DFA_DASH,       /* the byte after "-" */
+    ARGVE_DFA_DDASH,      /* the byte after "--" */
+    ARGVE_DFA_FLAG,       /* the next flag in a cluster */
+    ARGVE_DFA_NAME,       /* the name of a long flag */
+    ARGVE_DFA_TEXT,       /* positional argument */
+    ARGVE_DFA_SHORT,      /* short flag */
+    ARGVE_DFA_BAD,        /* invalid short flag */
+    ARGVE_DFA_LONG,       /* long flag */
+    ARGVE_DFA_END,        /* "--name" */
+    ARGVE_DFA_EQUAL,      /* "--name=" */
+    ARGVE_DFA_DONE,       /* no value */
+    ARGVE_DFA_CLUSTER,    /* "-ab" without value */
+    ARGVE_DFA_UNNEEDED,   /* "--name=<value>" without need_arg */
+    ARGVE_DFA_NO_SHORT,   /* "-o" at the end of arguments */
+    ARGVE_DFA_NO_LONG,    /* "--name" at the end of arguments */
+    ARGVE_DFA_NEXT,       /* "-o <value>", "--name <value>" */
+    ARGVE_DFA_ATTACHED    /* "-o<value>", "--name=<value>" */
+};
+
+/* byte classes: NUL, '-', '=', other visible ASCII, anything else */
+static const unsigned char argve_dfa_class[256] = {
+    0, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+};
+
+static const unsigned char argve_dfa_next[ARGVE_DFA_TEXT][5] = {
+    {ARGVE_DFA_TEXT, ARGVE_DFA_DASH, ARGVE_DFA_TEXT, ARGVE_DFA_TEXT,
+     ARGVE_DFA_TEXT},
+    {ARGVE_DFA_TEXT, ARGVE_DFA_DDASH, ARGVE_DFA_SHORT, ARGVE_DFA_SHORT,
+     ARGVE_DFA_BAD},
+    {ARGVE_DFA_TEXT, ARGVE_DFA_LONG, ARGVE_DFA_LONG, ARGVE_DFA_LONG,
+     ARGVE_DFA_LONG},
+    {ARGVE_DFA_BAD, ARGVE_DFA_BAD, ARGVE_DFA_SHORT, ARGVE_DFA_SHORT,
+     ARGVE_DFA_BAD},
+    {ARGVE_DFA_END, ARGVE_DFA_NAME, ARGVE_DFA_EQUAL, ARGVE_DFA_NAME,
+     ARGVE_DFA_NAME}
+};
+
+static const unsigned char argve_dfa_value[2][8] = {
+    {ARGVE_DFA_DONE, ARGVE_DFA_DONE, ARGVE_DFA_CLUSTER, ARGVE_DFA_CLUSTER,
+     ARGVE_DFA_NO_SHORT, ARGVE_DFA_NEXT, ARGVE_DFA_ATTACHED,
+     ARGVE_DFA_ATTACHED},
+    {ARGVE_DFA_DONE, ARGVE_DFA_DONE, ARGVE_DFA_UNNEEDED, ARGVE_DFA_UNNEEDED,
+     ARGVE_DFA_NO_LONG, ARGVE_DFA_NEXT, ARGVE_DFA_ATTACHED,
+     ARGVE_DFA_ATTACHED}
+};
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Same as argve_next but driven by the tables above.
+ /
+ / Jumps to actions are computed gotos with GCC and compatible compilers
+ / unless ARGVE_H_NO_COMPUTED_GOTO is defined, otherwise a switch.  Define
+ / ARGVE_H_ENGINE_DFA to have argve_next run this engine instead.
+\*/
+ARGVE_H_API
+argve_type argve_next_dfa(argve_state *state)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+#if defined(__GNUC__) && !defined(ARGVE_H_NO_COMPUTED_GOTO)
+    static void *const actions[] = {
+        __extension__ &&text, __extension__ &&flag, __extension__ &&bad,
+        __extension__ &&name, __extension__ &&value, __extension__ &&value,
+        __extension__ &&done, __extension__ &&cluster,
+        __extension__ &&unneeded, __extension__ &&no_short,
+        __extension__ &&no_long, __extension__ &&next,
+        __extension__ &&attached
+    };
+#define ARGVE_DFA_JUMP(a) \
+    __extension__ ({ goto *actions[(a) - ARGVE_DFA_TEXT]; })
+#else
+#define ARGVE_DFA_JUMP(a) \
+    switch (a) { \
+    case ARGVE_DFA_TEXT: goto text; \
+    case ARGVE_DFA_SHORT: goto flag; \
+    case ARGVE_DFA_BAD: goto bad; \
+    case ARGVE_DFA_LONG: goto name; \
+    case ARGVE_DFA_END: goto value; \
+    case ARGVE_DFA_EQUAL: goto value; \
+    case ARGVE_DFA_CLUSTER: goto cluster; \
+    case ARGVE_DFA_UNNEEDED: goto unneeded; \
+    case ARGVE_DFA_NO_SHORT: goto no_short; \
+    case ARGVE_DFA_NO_LONG: goto no_long; \
+    case ARGVE_DFA_NEXT: goto next; \
+    case ARGVE_DFA_ATTACHED: goto attached; \
+    default: goto done; \
+    }
+#endif
+    const unsigned char *p;
+    char *arg, *val = NULL;
+    int s, c;
+
+#ifdef ARGVE_H_WITH_CHOICES
+    state->choice = -1;
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    state->valstr = NULL;
+    state->keylen = -1;
+#endif
+    if (argve_in_cluster(state)) {
+        /* process the next flag; -abc => -bc */
+        state->argstr = NULL;
+        arg = state->optstr;
+        p = (const unsigned char *)arg + 1;
+        s = ARGVE_DFA_FLAG;
+    } else if (state->argc > 0) {
+        /* the type of a found short flag unless it turns out otherwise */
+        state->type = ARGVE_SHORT;
+        state->option = NULL;
+        state->optstr = NULL;
         state->argstr = NULL;
         arg = state->argv[0];
-        if (arg[0] == '-' && arg[1] != '-' && arg[1] != '\0') {
-            /* short flags; visible ASCII chars only; -a -b -ab<value> */
-            c = argve_to_short_opt(arg[1]);
-            state->option = argve_match_short(state->options, c);
-            if (state->option != NULL) {
-                state->type = ARGVE_SHORT;
-                state->optstr = arg + 1;
-                argve_advance(state);
-                if (state->option->need_arg) {
-                    if (state->optstr[1] != '\0') {
-                        /* -o<value> */
-                        state->argstr = state->optstr + 1;
-                    } else if (state->argc > 0) {
-                        /* -o <value> */
-                        state->argstr = state->argv[0];
-                        argve_advance(state);
-                    } else {
-                        state->type = ARGVE_ERR_ARG_SHORT;
-                    }
-                } else if (state->optstr[1] != '\0') {
-                    state->type = ARGVE_CLUSTER;
-                }
-            } else {
-                state->type = ARGVE_ERR_DEF_SHORT;
-                state->optstr = arg + 1;
-                argve_advance(state);
+        argve_advance(state);
+        p = (const unsigned char *)arg;
+        s = ARGVE_DFA_START;
+    } else {
+        state->type = ARGVE_END;
+        state->option = NULL;
+        state->optstr = NULL;
+        state->argstr = NULL;
+        return state->type;
+    }
+scan:
+    do {
+        s = argve_dfa_next[s][argve_dfa_class[*p++]];
+    } while (s < ARGVE_DFA_TEXT);
+    ARGVE_DFA_JUMP(s);
+
+text:
+    /* positional arguments including "--" and "-" */
+    state->type = ARGVE_TEXT;
+    state->argstr = arg;
+    return state->type;
+bad:
+    c = 0;
+    goto lookup;
+flag:
+    c = p[-1];
+lookup:
+    /* short flags; visible ASCII chars only; -a -b -ab<value> */
+    state->optstr = (char *)p - 1;
+    state->option = argve_lookup_short(state, c);
+    if (state->option == NULL) {
+        state->type = ARGVE_ERR_DEF_SHORT;
+        return state->type;
+    }
+    val = state->optstr + 1;
+    ARGVE_DFA_JUMP(argve_dfa_value[0][(state->option->need_arg != 0) * 4
+                                      + (*val != '\0') * 2
+                                      + (state->argc > 0)]);
+name:
+    /* long flags; visible ASCII chars only; --name --name=<value> */
+    state->option = argve_lookup_long(state, arg);
+    state->optstr = arg + 2;
+    if (state->option == NULL) {
+        state->type = ARGVE_ERR_DEF_LONG;
+        return state->type;
+    }
+    state->type = ARGVE_LONG;
+    p = (const unsigned char *)arg + 2;
+    s = ARGVE_DFA_NAME;
+    goto scan;
+value:
+    val = (char *)p;
+    ARGVE_DFA_JUMP(argve_dfa_value[1][(state->option->need_arg != 0) * 4
+                                      + (s == ARGVE_DFA_EQUAL) * 2
+                                      + (state->argc > 0)]);
+cluster:
+    state->type = ARGVE_CLUSTER;
+done:
+    return state->type;
+unneeded:
+    state->type = ARGVE_ERR_ARG_LONG;
+attached:
+    state->argstr = val;
+#ifdef ARGVE_H_WITH_CHOICES
+    argve_choose(state);
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    argve_split(state);
+#endif
+    return state->type;
+no_short:
+    state->type = ARGVE_ERR_ARG_SHORT;
+    return state->type;
+no_long:
+    state->type = ARGVE_ERR_ARG_LONG;
+    return state->type;
+next:
+    state->argstr = state->argv[0];
+    argve_advance(state);
+#ifdef ARGVE_H_WITH_CHOICES
+    argve_choose(state);
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    argve_split(state);
+#endif
+    return state->type;
+#undef ARGVE_DFA_JUMP
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_DFA */
+
+/* Parse the next argument.
+ /
+ / If a cluster of short flags is found in an argument string "-<chars>",
+ /     state->optstr is the start of each single-character option name,
+ /     state->argstr is NULL, the remaining <chars> or the next argument;
+ /
+ / If a short flag is found in an argument string "-o[<value>]",
+ /     state->optstr is the start of the single-character option name,
+ /     state->argstr is either NULL, <value> or the next argument string;
+ /
+ / If a long flag is found in an argument string "--name[=<value>]",
+ /     state->optstr is the start of the option name,
+ /     state->argstr is either NULL, <value> or the next argument string;
+ /
+ / If an error happens,
+ /     state->optstr points to undefined option name,
+ /     state->argstr is <value> for --name=<value> where <value> is unneeded,
+ /     stop processing the current argument,
+ /     report the error and prepare to handle the next argument as normal;
+ /
+ / Otherwise, the next argument is a positional argument.
+\*/
+ARGVE_H_API
+argve_type argve_next(argve_state *state)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+#ifdef ARGVE_H_ENGINE_DFA
+    return argve_next_dfa(state);
+#else
+    int c; char *arg; argve_type kind;
+
+    /* parse cluster of short flags */
+    if (argve_in_cluster(state)) {
+        /* process the next flag; -abc => -bc */
+        state->optstr += 1;
+        state->argstr = NULL;
+        c = argve_to_short_opt(state->optstr[0]);
+        state->option = argve_lookup_short(state, c);
+        if (state->option != NULL) {
+            /*state->type = ARGVE_CLUSTER;*/
+            if (state->option->need_arg) {
+                if (state->optstr[1] != '\0') {
+                    /* -o<value> */
+                    state->argstr = state->optstr + 1;
+                } else if (state->argc > 0) {
+                    /* -o <value> */
+                    state->argstr = state->argv[0];
+                    argve_advance(state);
+                } else {
+                    state->type = ARGVE_ERR_ARG_SHORT;
+                }
+            }
+        } else {
+            state->type = ARGVE_ERR_DEF_SHORT;
+        }
+#ifdef ARGVE_H_WITH_CHOICES
+        argve_choose(state);
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+        argve_split(state);
+#endif
+        return state->type;
+    }
+
+    /* parse new argument */
+    if (state->argc > 0) {
+        state->type = ARGVE_ERR_UNKNOWN;
+        state->option = NULL;
+        state->optstr = NULL;
+        state->argstr = NULL;
+        arg = state->argv[0];
+        kind = argve_next_kind(state);
+        if (kind == ARGVE_SHORT) {
+            /* short flags; visible ASCII chars only; -a -b -ab<value> */
+            c = argve_to_short_opt(arg[1]);
+            state->option = argve_lookup_short(state, c);
+            if (state->option != NULL) {
+                state->type = ARGVE_SHORT;
+                state->optstr = arg + 1;
+                argve_advance(state);
+                if (state->option->need_arg) {
+                    if (state->optstr[1] != '\0') {
+                        /* -o<value> */
+                        state->argstr = state->optstr + 1;
+                    } else if (state->argc > 0) {
+                        /* -o <value> */
+                        state->argstr = state->argv[0];
+                        argve_advance(state);
+                    } else {
+                        state->type = ARGVE_ERR_ARG_SHORT;
+                    }
+                } else if (state->optstr[1] != '\0') {
+                    state->type = ARGVE_CLUSTER;
+                }
+            } else {
+                state->type = ARGVE_ERR_DEF_SHORT;
+                state->optstr = arg + 1;
+                argve_advance(state);
+            }
+        } else if (kind == ARGVE_LONG) {
+            /* long flags; visible ASCII chars only; --name --name=<value> */
+            state->option = argve_lookup_long(state, arg);
+            arg += 2;
+            if (state->option != NULL) {
+                state->type = ARGVE_LONG;
+                state->optstr = arg;
+                argve_advance(state);
+                while (*arg && *arg != '=') {
+                    arg += 1;
+                }
+                if (state->option->need_arg) {
+                    if (*arg) {
+                        /* --name=<value> */
+                        state->argstr = arg + 1;
+                    } else if (state->argc > 0) {
+                        /* --name <value> */
+                        state->argstr = state->argv[0];
+                        argve_advance(state);
+                    } else {
+                        state->type = ARGVE_ERR_ARG_LONG;
+                    }
+                } else if (*arg) {
+                    state->type = ARGVE_ERR_ARG_LONG;
+                    state->argstr = arg + 1;
+                }
+            } else {
+                state->type = ARGVE_ERR_DEF_LONG;
+                state->optstr = arg;
+                argve_advance(state);
+            }
+        } else {
+            /* positional arguments including "--" and "-" */
+            state->type = ARGVE_TEXT;
+            state->argstr = arg;
+            argve_advance(state);
+        }
+    } else {
+        state->type = ARGVE_END;
+        state->option = NULL;
+        state->optstr = NULL;
+        state->argstr = NULL;
+    }
+#ifdef ARGVE_H_WITH_CHOICES
+    argve_choose(state);
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    argve_split(state);
+#endif
+    return state->type;
+#endif /* ARGVE_H_ENGINE_DFA */
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Initialize the parser state for iteration of command-line arguments.
+ /
+ / Must be called before the first use of argve_next with new parameters.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_init(argve_state *state, argve_option *opts, int argc, char **argv)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    argve_option *p = opts;
+    int i;
+
+    if (state == NULL || opts == NULL || argc < 0 || argv == NULL) {
+        return 0;
+    }
+    while (!argve_option_end(p)) {
+        /* names of long flags must contain only visible ASCII chars */
+        if (p->longopt != NULL && argve_to_long_opt(p->longopt, 0) == NULL) {
+            return 0;
+        }
+        p += 1;
+    }
+    /* argv needs not be NULL-terminated, but must not contain any NULL */
+    for (i = 0; i < argc; i += 1) {
+        if (argv[i] == NULL) {
+            return 0;
+        }
+    }
+    state->options = opts;
+    state->option = NULL;
+    state->optstr = NULL;
+    state->argstr = NULL;
+    state->argv = argv;
+    state->argc = argc;
+    state->type = ARGVE_ERR_UNKNOWN;
+#ifdef ARGVE_H_WITH_ADAPTIVE
+    state->adaptive = NULL;
+#endif
+#ifdef ARGVE_H_WITH_BLOOM
+    state->bloom = NULL;
+#endif
+#ifdef ARGVE_H_WITH_KINDS
+    state->kinds = NULL;
+#endif
+#ifdef ARGVE_H_WITH_INDEX
+    state->index = NULL;
+#endif
+#ifdef ARGVE_H_WITH_CHOICES
+    state->choices = NULL;
+    state->choice = -1;
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    state->pairs = NULL;
+    state->valstr = NULL;
+    state->keylen = -1;
+#endif
+#ifdef ARGVE_H_WITH_HOOKS
+    state->match_short = NULL;
+    state->match_long = NULL;
+#endif
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+#ifdef ARGVE_H_WITH_ADAPTIVE
+/*\
+ / Initialize hit counters for adaptive probe order of a table of options.
+ /
+ / <slots> is caller memory for at least <size> slots, one per option.  The
+ / probe order is refreshed after every <warmup> lookups; 0 freezes it.
+ / Attach it with state->adaptive after each call of argve_init; the same
+ / counters can be reused for every command line parsed with <opts>.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_adaptive_init(argve_adaptive *adaptive, argve_option *opts,
+                        argve_slot *slots, int size, unsigned long warmup)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int i, j, n = 0;
+
+    if (adaptive == NULL || opts == NULL || slots == NULL || size < 0) {
+        return 0;
+    }
+    while (!argve_option_end(&opts[n])) {
+        if (n == size) {
+            return 0;
+        }
+        n += 1;
+    }
+    for (i = 0; i < n; i += 1) {
+        slots[i].hits = 0;
+        slots[i].index = i;
+        slots[i].shadowed = 0;
+        for (j = 0; j < i; j += 1) {
+            if (opts[j].shortopt == opts[i].shortopt) {
+                slots[i].shadowed |= 1;
+            }
+            if (opts[i].longopt != NULL
+                    && argve_match_name(opts[j].longopt, opts[i].longopt)) {
+                slots[i].shadowed |= 2;
+            }
+        }
+    }
+    adaptive->options = opts;
+    adaptive->slots = slots;
+    adaptive->count = n;
+    adaptive->lookups = 0;
+    adaptive->warmup = warmup;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_ADAPTIVE */
+
+#ifdef ARGVE_H_WITH_BLOOM
+/*\
+ / Build a Bloom filter of the names of long flags in a table of options.
+ /
+ / <memory> is caller memory of <size> bytes; the largest power of 2 bits
+ / fitting in it is used.  About 2 bytes per long flag keep false positives
+ / around 1%.  Attach it with state->bloom after each call of argve_init.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_bloom_init(argve_bloom *bloom, argve_option *opts,
+                     unsigned char *memory, unsigned long size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    argve_option *p;
+    unsigned long i, h, bits = 8;
+
+    if (bloom == NULL || opts == NULL || memory == NULL || size == 0) {
+        return 0;
+    }
+    while (bits / 8 * 2 <= size && bits * 2 > bits) {
+        bits *= 2;
+    }
+    for (i = 0; i < bits / 8; i += 1) {
+        memory[i] = 0;
+    }
+    bloom->options = opts;
+    bloom->bits = memory;
+    bloom->mask = bits - 1;
+    for (p = opts; !argve_option_end(p); p += 1) {
+        if (p->longopt != NULL) {
+            h = argve_bloom_hash(p->longopt);
+            i = h & bloom->mask;
+            memory[i >> 3] |= 1 << (i & 7);
+            i = ((h >> 16) | (h << 16)) & bloom->mask;
+            memory[i >> 3] |= 1 << (i & 7);
+        }
+    }
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_BLOOM */
+
+#ifdef ARGVE_H_WITH_KINDS
+/*\
+ / Classify <argc> arguments in <argv> into <kinds> as argve_kind does.
+ /
+ / This is a separate pass over argv so that the strings are prefetched a few
+ / arguments ahead and argve_next no longer needs to inspect them.  Attach
+ / <kinds> with state->kinds after argve_init for the same arguments.
+ /
+ / The pass only pays off when many arguments are flags; for mostly file
+ / paths it costs about as much as it saves, and argve_skip_text is what
+ / makes such command lines faster to parse.
+\*/
+ARGVE_H_API
+void argve_classify(char **argv, int argc, unsigned char *kinds)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int i;
+
+    for (i = 0; i < argc; i += 1) {
+#ifdef __GNUC__
+        if (i + 8 < argc) {
+            __builtin_prefetch(argv[i + 8]);
+        }
+#endif
+        kinds[i] = (unsigned char)argve_kind(argv[i]);
+    }
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Skip the run of positional arguments ahead as if argve_next was called
+ / once for each of them.
+ /
+ / Nothing is skipped in the middle of a cluster of short flags.  The run of
+ / arguments are state->argv[-n] to state->argv[-1] for a positive <n>, and
+ / state->argstr is the last one.
+ /
+ / Return the number <n> of positional arguments skipped.
+\*/
+ARGVE_H_API
+int argve_skip_text(argve_state *state)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int n = 0;
+
+    if (argve_in_cluster(state)) {
+        return 0;
+    }
+    if (state->kinds != NULL) {
+        while (n < state->argc && state->kinds[n] == ARGVE_TEXT) {
+            n += 1;
+        }
+        state->kinds += n;
+    } else {
+        while (n < state->argc && argve_kind(state->argv[n]) == ARGVE_TEXT) {
+            n += 1;
+        }
+    }
+    if (n > 0) {
+        state->argc -= n;
+        state->argv += n;
+        state->type = ARGVE_TEXT;
+        state->option = NULL;
+        state->optstr = NULL;
+        state->argstr = state->argv[-1];
+#ifdef ARGVE_H_WITH_CHOICES
+        state->choice = -1;
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+        state->valstr = NULL;
+        state->keylen = -1;
+#endif
+    }
+    return n;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_KINDS */
+
+#ifdef ARGVE_H_WITH_PRESCAN
+/*\
+ / Find a few options, e.g. --config or --help, before the full table of
+ / options is known.
+ /
+ / The arguments are parsed exactly as argve_next does with <wanted> as the
+ / table of options, but an argument is skipped at once if its first byte
+ / after the dashes cannot start any of <wanted>.  Options of the full table
+ / that need an argument can be listed in <wanted> too, so that their values
+ / are not taken as flags.  <found> is caller memory for a pointer per
+ / option of <wanted>: the argument of the last occurrence of a flag that
+ / needs one, the name of the last occurrence of one that does not, or else
+ / NULL.  Errors are skipped as well.
+ /
+ / Return the number of occurrences found, or -1 if the arguments are
+ / invalid for argve_init.
+\*/
+ARGVE_H_API
+int argve_prescan(int argc, char **argv, argve_option *wanted, char **found)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned char shorts[32], longs[32], *bits;
+    argve_state state;
+    const char *arg;
+    int i, c, n = 0;
+
+    if (found == NULL || !argve_init(&state, wanted, argc, argv)) {
+        return -1;
+    }
+    for (i = 0; i < 32; i += 1) {
+        shorts[i] = longs[i] = 0;
+    }
+    for (i = 0; !argve_option_end(&wanted[i]); i += 1) {
+        found[i] = NULL;
+        if ((c = argve_to_short_opt((char)wanted[i].shortopt)) != 0
+                && c == wanted[i].shortopt) {
+            shorts[c >> 3] |= (unsigned char)(1 << (c & 7));
+        }
+        if (wanted[i].longopt != NULL && wanted[i].longopt[0] != '\0') {
+            c = (unsigned char)wanted[i].longopt[0];
+            longs[c >> 3] |= (unsigned char)(1 << (c & 7));
+        }
+    }
+    for (;;) {
+        if (!argve_in_cluster(&state)) {
+            if (state.argc <= 0) {
+                break;
+            }
+            /* "-" and "--" end up with 0, which never starts any flag */
+            arg = state.argv[0];
+            bits = arg[1] == '-' ? longs : shorts;
+            c = arg[0] == '-' ? (unsigned char)arg[1 + (arg[1] == '-')] : 0;
+            if (c == 0 || !(bits[c >> 3] & (1 << (c & 7)))) {
+                argve_advance(&state);
+                state.type = ARGVE_TEXT;
+                continue;
+            }
+        }
+        argve_next(&state);
+        if (state.option != NULL && !argve_error(&state)) {
+            found[state.option - wanted] = state.option->need_arg
+                                         ? state.argstr : state.optstr;
+            n += 1;
+        }
+    }
+    return n;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_PRESCAN */
+
+#ifdef ARGVE_H_WITH_INDEX
+/*\
+ / Build a structure-of-arrays view of a table of options.
+ /
+ / <names> is caller memory for at least <size> names, and <shorts> is for
+ / at least ARGVE_INDEX_WORDS(<size>) words.  The table must stay unchanged
+ / while the index is in use.  Attach it with state->index after each call
+ / of argve_init.  argve_next only uses it for tables of at least
+ / ARGVE_INDEX_MIN_SHORT options for short flags, and ARGVE_INDEX_MIN_LONG
+ / for long flags; scanning smaller tables linearly is as fast.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_index_init(argve_index *index, argve_option *opts,
+                     argve_name *names, unsigned long *shorts, int size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long i, c, n = 0;
+
+    if (index == NULL || opts == NULL || names == NULL || shorts == NULL
+            || size < 0) {
+        return 0;
+    }
+    while (!argve_option_end(&opts[n])) {
+        if (n == (unsigned long)size) {
+            return 0;
+        }
+        n += 1;
+    }
+    for (i = 0; i < ARGVE_INDEX_WORDS(n); i += 1) {
+        shorts[i] = 0;
+    }
+    for (i = 0; i < n; i += 1) {
+        c = (unsigned long)opts[i].shortopt;
+        if (c < 0x7F && argve_to_short_opt((char)c) != 0) {
+            shorts[i / sizeof(unsigned long)]
+                |= c << (i % sizeof(unsigned long) * 8);
+        }
+        names[i].name = opts[i].longopt;
+        names[i].length = 0;
+        if (opts[i].longopt != NULL) {
+            while (opts[i].longopt[names[i].length] != '\0') {
+                names[i].length += 1;
+            }
+        }
+    }
+    index->options = opts;
+    index->names = names;
+    index->shorts = shorts;
+    index->count = (int)n;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_INDEX */
+
+#ifdef ARGVE_H_WITH_CHOICES
+/*\
+ / Hash a NULL-terminated list of valid arguments into <slots>.
+ /
+ / <slots> is caller memory of at least <size> ints, more than the number of
+ / <names>; twice as many keep the probes short.  The first of duplicate
+ / names is the one found.  Attach the choices of each option with an array
+ / indexed like the table of options in state->choices, after argve_init.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_choices_init(argve_choices *choices, const char *const *names,
+                       int *slots, int size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long n = 0, m = 1, h;
+    int i;
+
+    if (choices == NULL || names == NULL || slots == NULL || size <= 0) {
+        return 0;
+    }
+    while (names[n] != NULL) {
+        n += 1;
+    }
+    while (m * 2 <= (unsigned long)size) {
+        m *= 2;
+    }
+    if (m <= n) {
+        return 0;
+    }
+    for (i = 0; (unsigned long)i < m; i += 1) {
+        slots[i] = -1;
+    }
+    choices->names = names;
+    choices->slots = slots;
+    choices->mask = m - 1;
+    choices->count = 0;
+    for (i = 0; (unsigned long)i < n; i += 1) {
+        if (argve_choice_find(choices, names[i]) < 0) {
+            h = argve_choice_hash(names[i]);
+            while (slots[h & choices->mask] >= 0) {
+                h += 1;
+            }
+            slots[h & choices->mask] = i;
+        }
+    }
+    choices->count = (int)n;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_CHOICES */
+
+#ifdef ARGVE_H_WITH_PAIRS
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+/*\
+ / Hash <n> bytes of a key with 32-bit FNV-1a.
+\*/
+static
+unsigned long argve_pair_hash(const char *s, int n)
+{
+    unsigned long h = 2166136261UL;
+
+    for (; n > 0; n -= 1, s += 1) {
+        h = ((h ^ (unsigned char)*s) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return h;
+}
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Prepare an empty collection of pairs in caller memory.
+ /
+ / <memory> holds at most <size> pairs, and <slots> is caller memory of
+ / 2 * <size> ints for hashing them by key.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_pairs_init(argve_pairs *pairs, argve_pair *memory, int *slots,
+                     int size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long m = 1, i;
+
+    if (pairs == NULL || memory == NULL || slots == NULL || size <= 0) {
+        return 0;
+    }
+    while (m * 2 <= (unsigned long)size * 2) {
+        m *= 2;
+    }
+    for (i = 0; i < m; i += 1) {
+        slots[i] = -1;
+    }
+    pairs->pairs = memory;
+    pairs->slots = slots;
+    pairs->mask = m - 1;
+    pairs->count = 0;
+    pairs->size = size;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Collect the pair split by argve_next, replacing the one with the same key.
+ /
+ / Call it for each flag whose state->keylen is not -1; the last value of a
+ / key wins and keeps the position where the key first appeared.
+ /
+ / Return the index of the pair, or -1 if it is not a pair or <pairs> is
+ / full.
+\*/
+ARGVE_H_API
+int argve_pairs_add(argve_pairs *pairs, const argve_state *state)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long h;
+    argve_pair *pair;
+    int i, n;
+
+    if (state->keylen < 0) {
+        return -1;
+    }
+    h = argve_pair_hash(state->argstr, state->keylen);
+    for (;; h += 1) {
+        if ((i = pairs->slots[h & pairs->mask]) < 0) {
+            if (pairs->count >= pairs->size) {
+                return -1;
+            }
+            i = pairs->slots[h & pairs->mask] = pairs->count++;
+            pair = &pairs->pairs[i];
+            pair->key = state->argstr;
+            pair->keylen = state->keylen;
+            break;
+        }
+        pair = &pairs->pairs[i];
+        if (pair->keylen == state->keylen) {
+            for (n = 0; n < pair->keylen; n += 1) {
+                if (pair->key[n] != state->argstr[n]) {
+                    break;
+                }
+            }
+            if (n == pair->keylen) {
+                break;
+            }
+        }
+    }
+    pair->option = state->option;
+    pair->value = state->valstr;
+    return i;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_PAIRS */
+
+#ifdef ARGVE_H_WITH_RUN
+/*\
+ / Parse the remaining arguments and call the handlers of what is found.
+ /
+ / A NULL handler of an option or positional argument skips it, and errors
+ / stop the parsing unless there is an error handler.  The parser state is
+ / the same as after argve_next when a handler is called.
+ /
+ / This is a convenience rather than a speedup: an indirect call per
+ / argument costs about what a switch over argve_next saves, and both run
+ / at the same speed in make bench.
+ /
+ / Return ARGVE_END when all arguments are parsed, otherwise return the
+ / result type of the last argument, either an error or one at which a
+ / handler returned nonzero.
+\*/
+ARGVE_H_API
+argve_type argve_run(argve_state *state, const argve_handlers *handlers,
+                     void *context)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    argve_handler handler;
+
+    while (argve_next(state) != ARGVE_END) {
+        if (argve_error(state)) {
+            if (handlers->error == NULL || handlers->error(context, state)) {
+                break;
+            }
+            continue;
+        }
+        if (state->type == ARGVE_TEXT) {
+            handler = handlers->text;
+        } else if (handlers->options != NULL) {
+            handler = handlers->options[state->option - state->options];
+        } else {
+            handler = NULL;
+        }
+        if (handler != NULL && handler(context, state->argstr)) {
+            break;
+        }
+    }
+    return state->type;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_RUN */
+
+#ifdef ARGVE_H_WITH_TOKENS
+/*\
+ / Record the parser state in <token> with strings relative to <argv>.
+ /
+ / <argv> is the array of arguments given to argve_init.
+\*/
+ARGVE_H_API
+void argve_to_token(const argve_state *state, char **argv,
+                    argve_token *token)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int next = (int)(state->argv - argv), last = next - 1;
+
+    token->type = state->type;
+    token->option = state->option != NULL
+                  ? (int)(state->option - state->options) : -1;
+    token->arg = token->value = token->next = next;
+    token->optoff = token->valoff = -1;
+    if (state->argstr != NULL) {
+        /* the value is the start of the last argument if not attached */
+        token->value = last;
+        token->valoff = (int)(state->argstr - argv[last]);
+        if (state->argstr == argv[last] && state->type != ARGVE_TEXT) {
+            token->arg = last - 1;
+        } else {
+            token->arg = last;
+        }
+    } else if (state->optstr != NULL) {
+        token->arg = last;
+    }
+    if (state->optstr != NULL) {
+        token->optoff = (int)(state->optstr - argv[token->arg]);
+    }
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Restore the parser state from <token> with strings relative to <argv>.
+ /
+ / <state> must have been initialized by argve_init with the same options
+ / and arguments <argv>, after which parsing continues from <token>.
+\*/
+ARGVE_H_API
+void argve_from_token(argve_state *state, char **argv,
+                      const argve_token *token)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int moved = (int)(argv + token->next - state->argv);
+
+#ifdef ARGVE_H_WITH_KINDS
+    if (state->kinds != NULL) {
+        state->kinds += moved;
+    }
+#endif
+    state->argc -= moved;
+    state->argv += moved;
+    state->type = token->type;
+    state->option = token->option >= 0
+                  ? state->options + token->option : NULL;
+    state->optstr = token->optoff >= 0
+                  ? argv[token->arg] + token->optoff : NULL;
+    state->argstr = token->valoff >= 0
+                  ? argv[token->value] + token->valoff : NULL;
+#ifdef ARGVE_H_WITH_CHOICES
+    argve_choose(state);
+#endif
+#ifdef ARGVE_H_WITH_PAIRS
+    argve_split(state);
+#endif
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Parse the remaining arguments into at most <size> tokens.
+ /
+ / <argv> is the array of arguments given to argve_init.  The last token is
+ / of type ARGVE_END unless <size> tokens are not enough, in which case
+ / parsing can go on with another call.
+ /
+ / Return the number of tokens stored.
+\*/
+ARGVE_H_API
+int argve_tokenize(argve_state *state, char **argv,
+                   argve_token *tokens, int size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int n = 0;
+
+    while (n < size) {
+        argve_next(state);
+        argve_to_token(state, argv, &tokens[n]);
+        n += 1;
+        if (state->type == ARGVE_END) {
+            break;
+        }
+    }
+    return n;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Tokenize the arguments again after an edit, from the first affected one.
+ /
+ / <state> must be freshly initialized by argve_init with the new arguments
+ / <argv>.  <tokens> holds <count> tokens of the previous parse with the same
+ / options, where the arguments before argv[<first>] were the same.  The
+ / tokens that end before argv[<first>] are kept, since a token only depends
+ / on the arguments it spans, except for a flag missing its value at the end
+ / of the old arguments, which may take argv[<first>] now.  The rest is
+ / tokenized as by argve_tokenize, with the same results as a full parse.
+ /
+ / Return the number of tokens in <tokens>, or -1 if <first> is out of range.
+\*/
+ARGVE_H_API
+int argve_retokenize(argve_state *state, char **argv, argve_token *tokens,
+                     int count, int size, int first)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    const argve_token *token;
+    int k = 0;
+
+    if (state->argv != argv || first < 0 || first > state->argc) {
+        return -1;
+    }
+    for (token = tokens; k < count && k < size; token += 1) {
+        if (token->type == ARGVE_END || token->next > first
+                || (token->next == first
+                    && (token->type == ARGVE_ERR_ARG_SHORT
+                        || (token->type == ARGVE_ERR_ARG_LONG
+                            && token->valoff < 0)))) {
+            break;
+        }
+        k += 1;
+    }
+    if (k > 0) {
+        argve_from_token(state, argv, &tokens[k - 1]);
+    }
+    return k + argve_tokenize(state, argv, tokens + k, size - k);
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_TOKENS */
+
+#ifdef ARGVE_H_WITH_BUILDER
+/*\
+ / Start building an empty argv in <argv> of <size> pointers including the
+ / terminating NULL, with <capacity> bytes of <arena> for rewritten ones.
+ /
+ / Return 1 if initialization succeeds, otherwise return 0.
+\*/
+ARGVE_H_API
+int argve_builder_init(argve_builder *builder, char **argv, int size,
+                       char *arena, unsigned long capacity)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    if (builder == NULL || argv == NULL || size <= 0
+            || (arena == NULL && capacity > 0)) {
+        return 0;
+    }
+    builder->argv = argv;
+    builder->argc = 0;
+    builder->size = size;
+    builder->arena = arena;
+    builder->used = 0;
+    builder->capacity = capacity;
+    argv[0] = NULL;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Append <count> arguments by pointer, e.g. the tail after "--".
+ /
+ / Return 1 if they fit, otherwise return 0 and append nothing.
+\*/
+ARGVE_H_API
+int argve_builder_append(argve_builder *builder, char **argv, int count)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    int i;
+
+    if (count < 0 || count >= builder->size - builder->argc) {
+        return 0;
+    }
+    for (i = 0; i < count; i += 1) {
+        builder->argv[builder->argc + i] = argv[i];
+    }
+    builder->argc += count;
+    builder->argv[builder->argc] = NULL;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Append <prefix> followed by <value> as one argument packed into the
+ / arena, e.g. ("--name=", value) or ("-D", value).  <value> may be NULL.
+ /
+ / Return 1 if it fits, otherwise return 0 and append nothing.
+\*/
+ARGVE_H_API
+int argve_builder_pack(argve_builder *builder, const char *prefix,
+                       const char *value)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long n = builder->used;
+
+    if (builder->argc + 1 >= builder->size) {
+        return 0;
+    }
+    for (; prefix != NULL && *prefix != '\0'; prefix += 1) {
+        if (n >= builder->capacity) {
+            return 0;
+        }
+        builder->arena[n++] = *prefix;
+    }
+    for (; value != NULL && *value != '\0'; value += 1) {
+        if (n >= builder->capacity) {
+            return 0;
+        }
+        builder->arena[n++] = *value;
+    }
+    if (n >= builder->capacity) {
+        return 0;
+    }
+    builder->arena[n++] = '\0';
+    builder->argv[builder->argc++] = builder->arena + builder->used;
+    builder->used = n;
+    builder->argv[builder->argc] = NULL;
+    return 1;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Forward what <token> parsed from <argv> with the same meaning.
+ /
+ / The arguments that a token spans are appended by pointer, except for a
+ / flag in a cluster of short flags, which is packed alone as "-c" (along
+ / with its attached value), so that the tokens of a cluster can be
+ / forwarded selectively.  ARGVE_END appends nothing.
+ /
+ / An unknown flag inside a cluster is refused: repacked alone it may mean
+ / something else, e.g. "-" of -o- would make "--", and -o-x would make
+ / the long flag "--x".
+ /
+ / Return 1 if it fits, otherwise return 0 and append nothing.
+\*/
+ARGVE_H_API
+int argve_builder_token(argve_builder *builder, char **argv,
+                        const argve_token *token)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    char flag[3];
+    int argc = builder->argc;
+    unsigned long used = builder->used;
+    int attached = token->valoff >= 0 && token->value == token->arg;
+
+    if (token->type == ARGVE_END) {
+        return 1;
+    }
+    if (token->type == ARGVE_ERR_DEF_SHORT && token->optoff > 1) {
+        return 0;
+    }
+    if (token->optoff < 0 || argv[token->arg][1] == '-'
+            || (token->optoff == 1 && token->type != ARGVE_CLUSTER)) {
+        /* the whole arguments: text, long flags, -o, -o<value>, -o <value> */
+        return argve_builder_append(builder, argv + token->arg,
+                                    token->next - token->arg);
+    }
+    flag[0] = '-';
+    flag[1] = argv[token->arg][token->optoff];
+    flag[2] = '\0';
+    if (attached) {
+        /* -c<value> */
+        if (argve_builder_pack(builder, "-",
+                               argv[token->arg] + token->optoff)) {
+            return 1;
+        }
+    } else if (argve_builder_pack(builder, flag, NULL)) {
+        if (token->valoff < 0 || argve_builder_append(
+                    builder, argv + token->value, 1)) {
+            return 1;
+        }
+    }
+    builder->argc = argc;
+    builder->used = used;
+    builder->argv[argc] = NULL;
+    return 0;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_BUILDER */
+
+#ifdef ARGVE_H_WITH_MANY
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+/*\
+ / Jobs [next, end) not yet claimed by any worker of argve_parse_many.
+\*/
+typedef struct {
+    pthread_mutex_t lock;
+    int next;
+    int end;
+    char padding[ARGVE_MANY_PADDING];
+} argve_range;
+
+typedef struct {
+    const argve_job *jobs;
+    argve_result *results;
+    argve_index *index;     /* read-only and shared by all workers */
+    argve_range *ranges;    /* one per worker */
+    int workers;            /* number of ranges */
+    int self;               /* the range owned by this worker */
+    int done;               /* number of jobs parsed through to the end */
+    char padding[ARGVE_MANY_PADDING];
+} argve_worker;
+
+/*\
+ / Claim the next job of a range from the front; return -1 if it is empty.
+\*/
+static
+int argve_range_pop(argve_range *range)
+{
+    int i = -1;
+
+    pthread_mutex_lock(&range->lock);
+    if (range->next < range->end) {
+        i = range->next;
+        range->next += 1;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return i;
+}
+
+/*\
+ / Move half of the jobs left in the range of another worker into the
+ / range of this one, from the back where its owner is not working.
+ /
+ / Return 1 if anything is stolen, otherwise return 0.
+\*/
+static
+int argve_range_steal(argve_worker *worker)
+{
+    argve_range *victim;
+    int i, k, n = 0, end = 0;
+
+    for (i = 1; i < worker->workers && n == 0; i += 1) {
+        victim = &worker->ranges[(worker->self + i) % worker->workers];
+        pthread_mutex_lock(&victim->lock);
+        if ((k = victim->end - victim->next) > 0) {
+            n = (k + 1) / 2;
+            end = victim->end;
+            victim->end -= n;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    if (n > 0) {
+        victim = &worker->ranges[worker->self];
+        pthread_mutex_lock(&victim->lock);
+        victim->next = end - n;
+        victim->end = end;
+        pthread_mutex_unlock(&victim->lock);
+    }
+    return n > 0;
+}
+
+/*\
+ / Parse the jobs of a worker and steal more until none is left anywhere.
+\*/
+static
+void * argve_worker_run(void *context)
+{
+    argve_worker *worker = (argve_worker *)context;
+    const argve_job *job;
+    argve_result *result;
+    argve_state state;
+    int i;
+
+    do {
+        while ((i = argve_range_pop(&worker->ranges[worker->self])) >= 0) {
+            job = &worker->jobs[i];
+            result = &worker->results[i];
+            result->count = -1;
+            if (argve_init(&state, worker->index->options,
+                           job->argc, job->argv)) {
+                state.index = worker->index;
+                result->count = argve_tokenize(&state, job->argv,
+                                               result->tokens, result->size);
+                worker->done += state.type == ARGVE_END;
             }
-        } else if (arg[0] == '-' && arg[1] == '-' && arg[2] != '\0') {
-            /* long flags; visible ASCII chars only; --name --name=<value> */
-            state->option = argve_match_long(state->options, arg);
-            arg += 2;
-            if (state->option != NULL) {
-                state->type = ARGVE_LONG;
-                state->optstr = arg;
-                argve_advance(state);
-                while (*arg && *arg != '=') {
-                    arg += 1;
-                }
-                if (state->option->need_arg) {
-                    if (*arg) {
-                        /* --name=<value> */
-                        state->argstr = arg + 1;
-                    } else if (state->argc > 0) {
-                        /* --name <value> */
-                        state->argstr = state->argv[0];
-                        argve_advance(state);
-                    } else {
-                        state->type = ARGVE_ERR_ARG_LONG;
-                    }
-                } else if (*arg) {
-                    state->type = ARGVE_ERR_ARG_LONG;
-                    state->argstr = arg + 1;
-                }
-            } else {
-                state->type = ARGVE_ERR_DEF_LONG;
-                state->optstr = arg;
-                argve_advance(state);
+        }
+    } while (argve_range_steal(worker));
+    return NULL;
+}
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Tokenize <count> independent command lines on up to <threads> threads.
+ /
+ / Every job is parsed with the options of <index>, which is only read and
+ / shared by all threads, into the slab of the result at the same position
+ / (see argve_tokenize).  The jobs are split evenly between the threads in
+ / contiguous ranges, and a thread that runs out of jobs steals half of what
+ / is left to another one.  The calling thread is one of the <threads>, so
+ / 1 parses all jobs without starting any thread; and if some threads fail
+ / to start, the others do their jobs.  <threads> is capped by
+ / ARGVE_MANY_THREADS.
+ /
+ / Return the number of jobs that are completely tokenized, i.e. with room
+ / for the last ARGVE_END token, or -1 if the arguments are invalid.
+\*/
+ARGVE_H_API
+int argve_parse_many(const argve_job *jobs, int count, argve_index *index,
+                     argve_result *results, int threads)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    argve_range ranges[ARGVE_MANY_THREADS];
+    argve_worker workers[ARGVE_MANY_THREADS];
+    pthread_t ids[ARGVE_MANY_THREADS];
+    int i, share, extra, started[ARGVE_MANY_THREADS], done = 0;
+
+    if (jobs == NULL || count < 0 || index == NULL || results == NULL
+            || threads <= 0) {
+        return -1;
+    }
+    if (threads > ARGVE_MANY_THREADS) {
+        threads = ARGVE_MANY_THREADS;
+    }
+    if (threads > count) {
+        threads = count > 0 ? count : 1;
+    }
+    /* the first <extra> ranges get one more job, without overflow */
+    share = count / threads;
+    extra = count % threads;
+    for (i = 0; i < threads; i += 1) {
+        pthread_mutex_init(&ranges[i].lock, NULL);
+        ranges[i].next = share * i + (i < extra ? i : extra);
+        ranges[i].end = ranges[i].next + share + (i < extra);
+        workers[i].jobs = jobs;
+        workers[i].results = results;
+        workers[i].index = index;
+        workers[i].ranges = ranges;
+        workers[i].workers = threads;
+        workers[i].self = i;
+        workers[i].done = 0;
+    }
+    for (i = 1; i < threads; i += 1) {
+        started[i] = pthread_create(&ids[i], NULL, argve_worker_run,
+                                    &workers[i]) == 0;
+    }
+    argve_worker_run(&workers[0]);
+    done = workers[0].done;
+    for (i = 1; i < threads; i += 1) {
+        if (started[i]) {
+            pthread_join(ids[i], NULL);
+        }
+        done += workers[i].done;
+    }
+    for (i = 0; i < threads; i += 1) {
+        pthread_mutex_destroy(&ranges[i].lock);
+    }
+    return done;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_MANY */
+
+#ifdef ARGVE_H_WITH_SNAPSHOT
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+/*\
+ / Snapshot layout, in 32-bit little-endian words:
+ /
+ /     "ARGV" version argc argv_hash options_hash tokens_hash count
+ /     (type option arg optoff value valoff next) * count
+ /
+ / argv_hash and options_hash are 64-bit FNV-1a, low word first, and
+ / tokens_hash is a 32-bit FNV-1a checksum of the tokens.
+ /
+ / The version must change whenever argve_type or argve_token changes.
+\*/
+#define ARGVE_SNAPSHOT_VERSION 2
+
+static
+void argve_snapshot_put(unsigned char *p, long x)
+{
+    unsigned long u = (unsigned long)x & 0xFFFFFFFFUL;
+
+    p[0] = (unsigned char)(u & 0xFF);
+    p[1] = (unsigned char)(u >> 8 & 0xFF);
+    p[2] = (unsigned char)(u >> 16 & 0xFF);
+    p[3] = (unsigned char)(u >> 24 & 0xFF);
+}
+
+static
+unsigned long argve_snapshot_word(const unsigned char *p)
+{
+    return (unsigned long)p[0] | (unsigned long)p[1] << 8
+         | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+}
+
+static
+int argve_snapshot_get(const unsigned char *p)
+{
+    unsigned long u = argve_snapshot_word(p);
+
+    return u < 0x80000000UL ? (int)u : -(int)(0xFFFFFFFFUL - u) - 1;
+}
+
+/*\
+ / Update 32-bit FNV-1a hash <h> with <n> bytes from <s>.
+\*/
+static
+unsigned long argve_snapshot_hash(unsigned long h, const unsigned char *s,
+                                  unsigned long n)
+{
+    while (n-- > 0) {
+        h = ((h ^ *s++) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return h;
+}
+
+/*\
+ / Update 64-bit FNV-1a hash <h>, in 16-bit limbs from the lowest, with <n>
+ / bytes from <s>; the prime is 2^40 + 0x1B3, and unsigned long may be 32-bit.
+\*/
+static
+void argve_snapshot_hash64(unsigned long h[4], const unsigned char *s,
+                           unsigned long n)
+{
+    unsigned long t0, t1, t2, t3;
+
+    while (n-- > 0) {
+        h[0] ^= *s++;
+        t0 = h[0] * 0x1B3;
+        t1 = h[1] * 0x1B3 + (t0 >> 16);
+        t2 = h[2] * 0x1B3 + (t1 >> 16) + (h[0] << 8);
+        t3 = h[3] * 0x1B3 + (t2 >> 16) + (h[1] << 8);
+        h[0] = t0 & 0xFFFF;
+        h[1] = t1 & 0xFFFF;
+        h[2] = t2 & 0xFFFF;
+        h[3] = t3 & 0xFFFF;
+    }
+}
+
+static
+void argve_snapshot_init64(unsigned long h[4])
+{
+    /* 0xCBF29CE484222325 */
+    h[0] = 0x2325;
+    h[1] = 0x8422;
+    h[2] = 0x9CE4;
+    h[3] = 0xCBF2;
+}
+
+/*\
+ / Hash the arguments and the table of options that tokens depend on into
+ / the words <key>: argv_hash low, high, options_hash low, high.
+\*/
+static
+void argve_snapshot_key(const argve_state *state, char **argv, int argc,
+                        unsigned long key[4])
+{
+    const argve_option *p;
+    unsigned char word[4];
+    unsigned long n, args[4], opts[4];
+    int i;
+
+    argve_snapshot_init64(args);
+    for (i = 0; i < argc; i += 1) {
+        for (n = 0; argv[i][n] != '\0'; n += 1) {
+            /* nothing */
+        }
+        argve_snapshot_hash64(args, (unsigned char *)argv[i], n + 1);
+    }
+    argve_snapshot_init64(opts);
+    for (p = state->options; !argve_option_end(p); p += 1) {
+        argve_snapshot_put(word, p->need_arg);
+        argve_snapshot_hash64(opts, word, 4);
+        argve_snapshot_put(word, p->shortopt);
+        argve_snapshot_hash64(opts, word, 4);
+        if (p->longopt != NULL) {
+            for (n = 0; p->longopt[n] != '\0'; n += 1) {
+                /* nothing */
             }
-        } else {
-            /* positional arguments including "--" and "-" */
-            state->type = ARGVE_TEXT;
-            state->argstr = arg;
-            argve_advance(state);
+            argve_snapshot_hash64(opts, (unsigned char *)p->longopt, n);
         }
-    } else {
-        state->type = ARGVE_END;
-        state->option = NULL;
-        state->optstr = NULL;
-        state->argstr = NULL;
+        /* names of long flags never include 0xFF */
+        word[0] = 0xFF;
+        argve_snapshot_hash64(opts, word, 1);
     }
-    return state->type;
+    key[0] = args[0] | args[1] << 16;
+    key[1] = args[2] | args[3] << 16;
+    key[2] = opts[0] | opts[1] << 16;
+    key[3] = opts[2] | opts[3] << 16;
+}
+
+/*\
+ / Check that the encoded <token> stays within <argv> and the options, so
+ / that a corrupted snapshot or a collision of hashes never leads
+ / argve_from_token out of bounds.  <next> is the end of the last token.
+\*/
+static
+int argve_snapshot_check(const unsigned char *p, char **argv, int argc,
+                         int options, int *next)
+{
+    long type = argve_snapshot_get(p + 0);
+    int option = argve_snapshot_get(p + 4);
+    int arg = argve_snapshot_get(p + 8);
+    int optoff = argve_snapshot_get(p + 12);
+    int value = argve_snapshot_get(p + 16);
+    int valoff = argve_snapshot_get(p + 20);
+    int end = argve_snapshot_get(p + 24);
+    long n;
+
+    if (type < ARGVE_END || type > ARGVE_ERR_CHOICE
+            || option < -1 || option >= options
+            || arg < 0 || arg > value || value > end
+            || end < *next || end > argc
+            || optoff < -1 || valoff < -1) {
+        return 0;
+    }
+    if (optoff >= 0) {
+        if (arg >= end) {
+            return 0;
+        }
+        for (n = 0; n < optoff && argv[arg][n] != '\0'; n += 1) {
+            /* nothing */
+        }
+        if (n < optoff) {
+            return 0;
+        }
+    }
+    if (valoff >= 0) {
+        if (value >= end) {
+            return 0;
+        }
+        for (n = 0; n < valoff && argv[value][n] != '\0'; n += 1) {
+            /* nothing */
+        }
+        if (n < valoff) {
+            return 0;
+        }
+    }
+    *next = end;
+    return 1;
+}
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+
+/*\
+ / Parse all arguments and encode the tokens into a snapshot in <buffer>.
+ /
+ / <state> must be freshly initialized by argve_init with arguments <argv>.
+ / The snapshot is only valid for the same arguments and the same table of
+ / options, which are checked by argve_snapshot_open using hash values.
+ / ARGVE_SNAPSHOT_SIZE(n) bytes are needed for <n> tokens including the
+ / last ARGVE_END, where <n> never exceeds 1 + the total size of argv.
+ /
+ / Return the size of the snapshot, or 0 if <buffer> is too small.
+\*/
+ARGVE_H_API
+unsigned long argve_snapshot_save(argve_state *state, char **argv,
+                                  unsigned char *buffer, unsigned long size)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    unsigned long key[4], used = ARGVE_SNAPSHOT_SIZE(0);
+    unsigned char *p = buffer + used;
+    argve_token token;
+    int argc = state->argc, count = 0;
+
+    if (state->argv != argv || state->type != ARGVE_ERR_UNKNOWN
+            || buffer == NULL || size < used) {
+        return 0;
+    }
+    argve_snapshot_key(state, argv, argc, key);
+    do {
+        if ((used += 28) > size) {
+            return 0;
+        }
+        argve_next(state);
+        argve_to_token(state, argv, &token);
+        argve_snapshot_put(p + 0, (long)token.type);
+        argve_snapshot_put(p + 4, token.option);
+        argve_snapshot_put(p + 8, token.arg);
+        argve_snapshot_put(p + 12, token.optoff);
+        argve_snapshot_put(p + 16, token.value);
+        argve_snapshot_put(p + 20, token.valoff);
+        argve_snapshot_put(p + 24, token.next);
+        p += 28;
+        count += 1;
+    } while (token.type != ARGVE_END);
+    buffer[0] = 'A'; buffer[1] = 'R'; buffer[2] = 'G'; buffer[3] = 'V';
+    argve_snapshot_put(buffer + 4, ARGVE_SNAPSHOT_VERSION);
+    argve_snapshot_put(buffer + 8, argc);
+    argve_snapshot_put(buffer + 12, (long)key[0]);
+    argve_snapshot_put(buffer + 16, (long)key[1]);
+    argve_snapshot_put(buffer + 20, (long)key[2]);
+    argve_snapshot_put(buffer + 24, (long)key[3]);
+    argve_snapshot_put(buffer + 28, (long)argve_snapshot_hash(
+                2166136261UL, buffer + ARGVE_SNAPSHOT_SIZE(0),
+                used - ARGVE_SNAPSHOT_SIZE(0)));
+    argve_snapshot_put(buffer + 32, count);
+    return used;
 }
 #else
 ;
 #endif /* ARGVE_H_WITH_IMPLEMENTATION */
 
 /*\
- / Initialize the parser state for iteration of command-line arguments.
+ / Validate a snapshot for replaying tokens with argve_snapshot_next.
  /
- / Must be called before the first use of argve_next with new parameters.
+ / <state> must be freshly initialized by argve_init with arguments <argv>.
+ / <data> can be read-only memory such as a file mapped with mmap(2), and
+ / must stay valid for the replay.
  /
- / Return 1 if initialization succeeds, otherwise return 0.
+ / Every token is checked to refer only to the arguments and the options,
+ / and to end with ARGVE_END at the end of the arguments.
+ /
+ / Return 1 if the snapshot matches the arguments and options, otherwise
+ / return 0 and the arguments have to be parsed as usual.
 \*/
 ARGVE_H_API
-int argve_init(argve_state *state, argve_option *opts, int argc, char **argv)
+int argve_snapshot_open(argve_snapshot *snapshot, const argve_state *state,
+                        char **argv, const unsigned char *data,
+                        unsigned long size)
 #ifdef ARGVE_H_WITH_IMPLEMENTATION
 {
-    argve_option *p = opts;
-    int i;
+    const argve_option *p;
+    unsigned long key[4];
+    int count, options = 0, next = 0, i;
 
-    if (state == NULL || opts == NULL || argc < 0 || argv == NULL) {
+    if (snapshot == NULL || state == NULL || data == NULL
+            || state->argv != argv || state->type != ARGVE_ERR_UNKNOWN
+            || size < ARGVE_SNAPSHOT_SIZE(1)
+            || data[0] != 'A' || data[1] != 'R'
+            || data[2] != 'G' || data[3] != 'V'
+            || argve_snapshot_get(data + 4) != ARGVE_SNAPSHOT_VERSION
+            || argve_snapshot_get(data + 8) != state->argc) {
         return 0;
     }
-    while (!argve_option_end(p)) {
-        /* names of long flags must contain only visible ASCII chars */
-        if (p->longopt != NULL && argve_to_long_opt(p->longopt, 0) == NULL) {
+    count = argve_snapshot_get(data + 32);
+    if (count <= 0 || (unsigned long)count
+                      > (size - ARGVE_SNAPSHOT_SIZE(0)) / 28) {
+        return 0;
+    }
+    argve_snapshot_key(state, argv, state->argc, key);
+    if (argve_snapshot_word(data + 12) != key[0]
+            || argve_snapshot_word(data + 16) != key[1]
+            || argve_snapshot_word(data + 20) != key[2]
+            || argve_snapshot_word(data + 24) != key[3]
+            || argve_snapshot_word(data + 28) != argve_snapshot_hash(
+                2166136261UL, data + ARGVE_SNAPSHOT_SIZE(0),
+                ARGVE_SNAPSHOT_SIZE(count) - ARGVE_SNAPSHOT_SIZE(0))) {
+        return 0;
+    }
+    for (p = state->options; !argve_option_end(p); p += 1) {
+        options += 1;
+    }
+    for (i = 0; i < count; i += 1) {
+        if (!argve_snapshot_check(data + ARGVE_SNAPSHOT_SIZE(i), argv,
+                                  state->argc, options, &next)) {
             return 0;
         }
-        p += 1;
     }
-    /* argv needs not be NULL-terminated, but must not contain any NULL */
-    for (i = 0; i < argc; i += 1) {
-        if (argv[i] == NULL) {
+    /* only the last token is the end */
+    for (i = 0; i < count - 1; i += 1) {
+        if (argve_snapshot_get(data + ARGVE_SNAPSHOT_SIZE(i)) == ARGVE_END) {
             return 0;
         }
     }
-    state->options = opts;
-    state->option = NULL;
-    state->optstr = NULL;
-    state->argstr = NULL;
-    state->argv = argv;
-    state->argc = argc;
-    state->type = ARGVE_ERR_UNKNOWN;
+    if (argve_snapshot_get(data + ARGVE_SNAPSHOT_SIZE(count - 1))
+            != ARGVE_END || next != state->argc) {
+        return 0;
+    }
+    snapshot->data = data + ARGVE_SNAPSHOT_SIZE(0);
+    snapshot->argv = argv;
+    snapshot->argc = state->argc;
+    snapshot->count = count;
+    snapshot->index = 0;
     return 1;
 }
 #else
 ;
 #endif /* ARGVE_H_WITH_IMPLEMENTATION */
 
+/*\
+ / Replay the next token from a snapshot, in place of argve_next.
+ /
+ / <state> must be the one validated by argve_snapshot_open.
+\*/
+ARGVE_H_API
+argve_type argve_snapshot_next(argve_snapshot *snapshot, argve_state *state)
+#ifdef ARGVE_H_WITH_IMPLEMENTATION
+{
+    const unsigned char *p;
+    argve_token token;
+
+    if (snapshot->index < snapshot->count) {
+        p = snapshot->data + 28 * (unsigned long)snapshot->index;
+        token.type = (argve_type)argve_snapshot_get(p + 0);
+        token.option = argve_snapshot_get(p + 4);
+        token.arg = argve_snapshot_get(p + 8);
+        token.optoff = argve_snapshot_get(p + 12);
+        token.value = argve_snapshot_get(p + 16);
+        token.valoff = argve_snapshot_get(p + 20);
+        token.next = argve_snapshot_get(p + 24);
+        argve_from_token(state, snapshot->argv, &token);
+        snapshot->index += 1;
+    }
+    return state->type;
+}
+#else
+;
+#endif /* ARGVE_H_WITH_IMPLEMENTATION */
+#endif /* ARGVE_H_WITH_SNAPSHOT */
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
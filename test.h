@@ -17,9 +17,13 @@
  / * A wrong assertion aborts the current test case immediately.
  / * A failed test case does not prevent checking other test cases.
  / * A test suite never prevents any other test suites from running.
- / * Test suites and test cases are not automatically registered.
+ / * Test suites and test cases are not automatically registered, unless
+ /   TEST_H_AUTO is defined, e.g. for RUN_ALL in TEST_MAIN.
  / * Test cases must be defined before test suites, which precedes TEST_MAIN.
- / * No thread safety yet.
+ / * Benchmarks are test cases with a BENCH loop, run only with --bench.
+ / * No thread safety yet, but test cases may run in parallel processes.
+ / * Results are lines of text, or records of JSON Lines, TAP or JUnit XML.
+ / * Suites and cases are selected by names or globs, checked by hashing.
  /
  / Sample code:
  /
@@ -88,111 +92,1630 @@
 "    program [-q] [-c <case>]...\n" \
 "    program [-q] [-s <suite> [-c <case>]...]...\n" \
 "    program [-q] [-c <case>]... [-s <suite> [-c <case>]...]...\n" \
+/* ... */
+
+#define TEST_H_HELP_OPTIONS \
 "\n""Options:\n" \
 "    -h, --help            Show this help information.\n" \
 "    -q, --quiet           Do not output logs of operations.\n" \
 "    -s, --suite <name>    Only run test cases in the specific suite.\n" \
 "    -c, --case <name>     Only run the specific test case in the suite.\n" \
+"    -x, --exclude <name>  Skip the specific test case in any suite.\n" \
+"                          Names may be globs with * and ? as wildcards.\n" \
+/* ... */
+
+#define TEST_H_HELP_PROCESSES \
+"    -j, --jobs <number>   Run test cases in parallel processes.\n" \
+"    -i, --isolate         Run every test case in a child process.\n" \
+"    -t, --timeout <secs>  Fail isolated test cases that run too long.\n" \
+"    --shard-index <i>     Only run the i-th shard of test cases (from 0).\n" \
+"    --shard-count <n>     Split test cases into <n> shards by name.\n" \
 /* ... */
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#define TEST_H_HELP_REPORTS \
+"    -d, --durations       Print the time used by every test case.\n" \
+"    -S, --slowest <n>     List the <n> slowest test cases at the end.\n" \
+"    -f, --format <name>   Output text, jsonl, tap or junit records.\n" \
+"    -l, --list            List the suites and test cases without running.\n" \
+/* ... */
+
+#define TEST_H_HELP_BENCH \
+"    -b, --bench           Also run the benchmarks (BENCH_CASE).\n" \
+"    --bench-time <ms>     Measure every benchmark for about <ms>.\n" \
+"    --pin <cpu>           Run benchmarks on the specific CPU only.\n" \
+"    --fifo                Run benchmarks under SCHED_FIFO if permitted.\n" \
+/* ... */
+
+/*\
+ / test.h never defines feature macros itself, which only work before the
+ / first #include of a file.  On Linux, define one at the top of the file,
+ / e.g. _POSIX_C_SOURCE 199309L, for clock_gettime(CLOCK_MONOTONIC);
+ / otherwise times come from gettimeofday(2), or time(3) without POSIX.
+\*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(TEST_H_NO_JOBS) && (defined(__unix__) || defined(__APPLE__))
+#define TEST_H_JOBS
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TEST_H_NONE         0
+#define TEST_H_FAILED       1
+#define TEST_H_FILTERED     2
+#define TEST_H_TODO         4
+
+/*\
+ / The formats of --format, written through a large buffer of stdout.
+\*/
+#define TEST_H_FORMAT_TEXT  0   /* [TEST] suite : case ... PASSED */
+#define TEST_H_FORMAT_JSONL 1   /* one JSON object per line */
+#define TEST_H_FORMAT_TAP   2   /* Test Anything Protocol version 13 */
+#define TEST_H_FORMAT_JUNIT 3   /* JUnit XML */
+
+#ifndef TEST_H_BUFFER_SIZE
+#define TEST_H_BUFFER_SIZE  65536
+#endif
+
+/*\
+ / The filters of -s, -c and -x, where names may be globs with * and ?.
+ /
+ / The patterns are kept in one growing array, and compiled on the first
+ / check into an open-addressing hash of exact names, followed by the list
+ / of globs, so that a test case is checked by a few lookups.
+\*/
+typedef struct test_h_pattern {
+    const char *suite;  /* NULL for any suite */
+    const char *test;   /* NULL for any test case */
+    int exclude;        /* a test case to skip, with .suite NULL */
+    int glob;
+} test_h_pattern_t;
+
+typedef struct test_h_filter {
+    test_h_pattern_t *patterns;
+    int count;
+    int size;
+    int includes;   /* patterns that select test cases */
+    int anycase;    /* includes of test cases in any suite */
+    long *index;    /* NULL until compiled, see test_h_compile_filter */
+    long mask;      /* the size of the hash - 1 */
+    int globs;      /* the number of globs after the hash */
+} test_h_filter_t;
+
+/*\
+ / The resources used by a test case, or used so far by the process.
+\*/
+typedef struct test_h_stats {
+    double wall;    /* in seconds, monotonic where possible */
+    double cpu;     /* in seconds, user + system */
+    long minflt;    /* page faults without I/O */
+    long majflt;    /* page faults with I/O */
+    long maxrss;    /* in KiB, the peak of the process */
+} test_h_stats_t;
+
+/*\
+ / The state of the BENCH loop of a benchmark, see test_h_bench_next.
+\*/
+#define TEST_H_BENCH_SAMPLES 31
+
+typedef struct test_h_bench {
+    long n;         /* iterations per sample */
+    long i;         /* iterations left in the sample */
+    int phase;      /* 0 before, 1 scaling and warming up, 2 sampling */
+    int count;      /* samples taken */
+    double target;  /* in seconds per sample */
+    double start;
+    double ticks;   /* the time stamp counter at the start, if any */
+    double ns[TEST_H_BENCH_SAMPLES];        /* per iteration */
+    double cycles[TEST_H_BENCH_SAMPLES];
+} test_h_bench_t;
+
+typedef struct test_h_timing {
+    const char *suite;
+    const char *name;
+    test_h_stats_t stats;
+} test_h_timing_t;
+
+/*\
+ / Worker processes of -j <number>, forked on the first call of TEST.
+ /
+ / The calls of TEST and the ends of suites are numbered as units in the
+ / order of the source.  Every worker walks through all of them, but runs
+ / only the units that it claims first, so the code of suites runs in all
+ / workers while every test case runs once.  The output of each worker goes
+ / to a file of its own, and the ranges of it written by the units are
+ / recorded along with the counters, to be merged by the parent in order.
+\*/
+typedef struct test_h_pool {
+    int worker;     /* 0 for the parent */
+    int workers;
+    long unit;      /* the number of the next unit */
+    long mark;      /* the end of the output recorded */
+    int lock[2];    /* a pipe holding the number of the next free unit */
+    int saved;      /* the original stdout */
+    int *files;     /* output and records of each worker */
+    long *pids;
+    int total;      /* counters before the current unit */
+    int passed;
+    int failed;
+    int todo;
+} test_h_pool_t;
+
+typedef struct test_h_record {
+    long unit;
+    long kind;      /* 0 for the output before the unit */
+    long start;
+    long end;
+    int worker;
+    int total;      /* counters of the unit */
+    int passed;
+    int failed;
+    int todo;
+    test_h_timing_t timing;
+} test_h_record_t;
+
+typedef struct test_h_globaldata {
+    int total;
+    int passed;
+    int failed;
+    int todo;       /* test cases not counted in total */
+    int silent;
+    int format;     /* TEST_H_FORMAT_* */
+    test_h_filter_t filter;
+    int jobs;
+    test_h_pool_t *pool;
+    int shard;      /* see test_h_in_shard */
+    int shards;     /* 0 or 1 for all test cases */
+    int isolate;
+    int timeout;    /* in seconds, 0 for no limit */
+    int child;      /* in the child process of an isolated test case */
+    int durations;
+    int slowest;
+    test_h_timing_t last;       /* the last test case, if .name != NULL */
+    test_h_timing_t *timings;   /* test cases for --slowest <n> */
+    int timed;
+    int timings_size;
+    int list;
+    int bench;
+    int bench_time;     /* in milliseconds */
+    int pin;            /* 1 + the CPU to run benchmarks on, or 0 */
+    int fifo;
+} test_h_globaldata_t;
+
+typedef struct test_h_suitedata {
+    const char *name;
+    const char *func;
+    int flags;
+    void *userdata;
+    test_h_globaldata_t *global;
+} test_h_suitedata_t;
+
+typedef struct test_h_testdata {
+    const char *name;
+    const char *func;
+    int flags;
+    int lineno;
+    const char *message;
+    void *userdata;
+    test_h_stats_t stats;
+    test_h_bench_t *bench;
+} test_h_testdata_t;
+
+#ifdef TEST_H_AUTO
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "TEST_H_AUTO needs __attribute__((constructor))"
+#endif
+/*\
+ / A suite, test case or benchmark registered by its definition before main
+ / with TEST_H_AUTO, so that schedulers may walk test_h_registry.
+\*/
+typedef struct test_h_entry {
+    const char *kind;   /* "SUITE", "TEST" or "BENCH" */
+    const char *name;
+    const char *func;
+    const char *file;
+    int line;
+    void (*suite)(test_h_globaldata_t *, void *);       /* or NULL */
+    void (*test)(test_h_suitedata_t *, void *);         /* or NULL */
+    struct test_h_entry *next;
+} test_h_entry_t;
+
+/* entries in the order of definition, as constructors run in a file */
+static test_h_entry_t *test_h_registry;
+
+static void
+test_h_register(test_h_entry_t *entry)
+{
+    static test_h_entry_t *last;
+
+    if (last != NULL) {
+        last->next = entry;
+    } else {
+        test_h_registry = entry;
+    }
+    last = entry;
+}
+
+#define TEST_H_REGISTER(kind, name, fn, suite, test) \
+    static test_h_entry_t test_h_entry_ ## fn = { \
+        kind, name, #fn, __FILE__, __LINE__, suite, test, NULL \
+    }; \
+    static void test_h_register_ ## fn(void) __attribute__((constructor)); \
+    static void test_h_register_ ## fn(void) \
+    { \
+        test_h_register(&test_h_entry_ ## fn); \
+    }
+
+/* run every registered suite with the same <userdata> */
+#define RUN_ALL(userdata) test_h_run_all(test_h_globaldata, userdata)
+
+static __attribute__((unused)) void
+test_h_run_all(test_h_globaldata_t *global, void *userdata)
+{
+    test_h_entry_t *entry;
+
+    for (entry = test_h_registry; entry != NULL; entry = entry->next) {
+        if (entry->suite != NULL) {
+            entry->suite(global, userdata);
+        }
+    }
+}
+#else
+#define TEST_H_REGISTER(kind, name, fn, suite, test) /* manual */
+#endif /* TEST_H_AUTO */
+
+/* for functions used by BENCH_CASE only */
+#if defined(__GNUC__) || defined(__clang__)
+#define TEST_H_MAYBE_UNUSED __attribute__((unused))
+#else
+#define TEST_H_MAYBE_UNUSED
+#endif
+
+#define TEST_H_ERROR_EXIT(x) \
+    do { \
+        fflush(stdout); \
+        fprintf(stderr, "\n[ERROR] %s#L%d %s\n", __FILE__, __LINE__, #x); \
+        exit(EXIT_FAILURE); \
+    } while (0)
+
+static int
+test_h_str_eq(const char *a, const char *b)
+{
+    return strcmp(a, b) == 0;
+}
+
+/* the wall-clock time in seconds, monotonic where possible */
+static double
+test_h_now(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        TEST_H_ERROR_EXIT(clock_gettime);
+    }
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#elif defined(TEST_H_JOBS)
+    struct timeval tv;
+
+    if (gettimeofday(&tv, NULL) != 0) {
+        TEST_H_ERROR_EXIT(gettimeofday);
+    }
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+    return (double)time(NULL);
+#endif
+}
+
+/* the resources used so far, see test_h_since */
+static void
+test_h_usage(test_h_stats_t *stats)
+{
+    stats->wall = test_h_now();
+#ifdef TEST_H_JOBS
+    {
+        struct rusage self, children;
+
+        if (getrusage(RUSAGE_SELF, &self) != 0
+                || getrusage(RUSAGE_CHILDREN, &children) != 0) {
+            TEST_H_ERROR_EXIT(getrusage);
+        }
+        /* isolated test cases are waited children */
+        stats->cpu = self.ru_utime.tv_sec + children.ru_utime.tv_sec
+                + self.ru_stime.tv_sec + children.ru_stime.tv_sec
+                + (self.ru_utime.tv_usec + children.ru_utime.tv_usec
+                   + self.ru_stime.tv_usec + children.ru_stime.tv_usec) / 1e6;
+        stats->minflt = self.ru_minflt + children.ru_minflt;
+        stats->majflt = self.ru_majflt + children.ru_majflt;
+        stats->maxrss = self.ru_maxrss > children.ru_maxrss
+                      ? self.ru_maxrss : children.ru_maxrss;
+#ifdef __APPLE__
+        stats->maxrss /= 1024;
+#endif
+    }
+#else
+    stats->cpu = (double)clock() / CLOCKS_PER_SEC;
+    stats->minflt = 0;
+    stats->majflt = 0;
+    stats->maxrss = 0;
+#endif
+}
+
+/* turn the usage from test_h_usage into the resources used since then */
+static void
+test_h_since(test_h_stats_t *stats)
+{
+    test_h_stats_t now;
+
+    test_h_usage(&now);
+    stats->wall = now.wall - stats->wall;
+    stats->cpu = now.cpu - stats->cpu;
+    stats->minflt = now.minflt - stats->minflt;
+    stats->majflt = now.majflt - stats->majflt;
+    stats->maxrss = now.maxrss;
+}
+
+/* the end of a line of result, with the time used if --durations */
+static void
+test_h_durations(test_h_globaldata_t *global, const test_h_stats_t *stats)
+{
+    if (global->durations) {
+        printf(" (%.3f ms)\n", stats->wall * 1e3);
+    } else {
+        printf("\n");
+    }
+}
+
+/* write <s> escaped for a JSON string, a TAP description or XML */
+static void
+test_h_escape(int format, const char *s)
+{
+    const unsigned char *p = (const unsigned char *)s;
+
+    for (; *p != '\0'; p += 1) {
+        if (format == TEST_H_FORMAT_JUNIT) {
+            if (*p == '&') {
+                fputs("&amp;", stdout);
+            } else if (*p == '<') {
+                fputs("&lt;", stdout);
+            } else if (*p == '>') {
+                fputs("&gt;", stdout);
+            } else if (*p == '"') {
+                fputs("&quot;", stdout);
+            } else if (*p == '\t' || *p == '\n' || *p == '\r') {
+                printf("&#%d;", *p);
+            } else {
+                /* other control characters are invalid in XML 1.0 */
+                putchar(*p < 0x20 ? '?' : *p);
+            }
+        } else if (format == TEST_H_FORMAT_TAP) {
+            if (*p == '#' || *p == '\\') {
+                putchar('\\');
+            }
+            putchar(*p < 0x20 ? ' ' : *p);
+        } else if (*p == '"' || *p == '\\') {
+            putchar('\\');
+            putchar(*p);
+        } else if (*p == '\n') {
+            fputs("\\n", stdout);
+        } else if (*p == '\t') {
+            fputs("\\t", stdout);
+        } else if (*p < 0x20) {
+            printf("\\u%04x", *p);
+        } else {
+            putchar(*p);
+        }
+    }
+}
+
+/* a quoted JSON string, which is also a double-quoted YAML scalar */
+static void
+test_h_quote(const char *s)
+{
+    putchar('"');
+    test_h_escape(TEST_H_FORMAT_JSONL, s);
+    putchar('"');
+}
+
+/*\
+ / Print the result of a test case in the --format of <global>.
+ /
+ / <file> is where the test case is defined, if known.  <detail> replaces
+ / PASSED, e.g. the figures of a benchmark.  A failure without a line number
+ / is a crash of an isolated test case, described by .message.
+\*/
+static void
+test_h_result(test_h_suitedata_t *suitedata, test_h_testdata_t *testdata,
+              const char *file, const char *detail)
+{
+    test_h_globaldata_t *global = suitedata->global;
+    const char *message = detail;
+    int failed = testdata->flags & TEST_H_FAILED;
+    int todo = !failed && (testdata->flags & TEST_H_TODO);
+
+    if (failed) {
+        message = testdata->message;
+    } else if (todo) {
+        message = NULL;
+    }
+    switch (global->format) {
+    case TEST_H_FORMAT_JSONL:
+        fputs("{\"suite\":", stdout);
+        test_h_quote(suitedata->name);
+        fputs(",\"case\":", stdout);
+        test_h_quote(testdata->name);
+        printf(",\"func\":\"%s.%s\",\"status\":\"%s\",\"file\":",
+               suitedata->func, testdata->func,
+               failed ? "failed" : todo ? "todo" : "passed");
+        if (file != NULL) {
+            test_h_quote(file);
+        } else {
+            fputs("null", stdout);
+        }
+        if (testdata->lineno > 0) {
+            printf(",\"line\":%d,\"message\":", testdata->lineno);
+        } else {
+            fputs(",\"line\":null,\"message\":", stdout);
+        }
+        if (message != NULL) {
+            test_h_quote(message);
+        } else {
+            fputs("null", stdout);
+        }
+        printf(",\"duration_ms\":%.6f}\n", testdata->stats.wall * 1e3);
+        break;
+    case TEST_H_FORMAT_TAP:
+        /* TAP counts "not ok ... # TODO" as expected to fail, not failed */
+        fputs(failed || todo ? "not ok - " : "ok - ", stdout);
+        test_h_escape(TEST_H_FORMAT_TAP, suitedata->name);
+        fputs(" : ", stdout);
+        test_h_escape(TEST_H_FORMAT_TAP, testdata->name);
+        printf("%s\n  ---\n  func: %s.%s\n",
+               todo ? " # TODO" : "", suitedata->func, testdata->func);
+        if (file != NULL) {
+            fputs("  file: ", stdout);
+            test_h_quote(file);
+            putchar('\n');
+        }
+        if (testdata->lineno > 0) {
+            printf("  line: %d\n", testdata->lineno);
+        }
+        if (message != NULL) {
+            fputs("  message: ", stdout);
+            test_h_quote(message);
+            putchar('\n');
+        }
+        printf("  duration_ms: %.6f\n  ...\n", testdata->stats.wall * 1e3);
+        break;
+    case TEST_H_FORMAT_JUNIT:
+        fputs("<testcase classname=\"", stdout);
+        test_h_escape(TEST_H_FORMAT_JUNIT, suitedata->name);
+        fputs("\" name=\"", stdout);
+        test_h_escape(TEST_H_FORMAT_JUNIT, testdata->name);
+        if (file != NULL) {
+            fputs("\" file=\"", stdout);
+            test_h_escape(TEST_H_FORMAT_JUNIT, file);
+        }
+        if (testdata->lineno > 0) {
+            printf("\" line=\"%d", testdata->lineno);
+        }
+        printf("\" time=\"%.9f\"", testdata->stats.wall);
+        if (failed) {
+            fputs("><failure message=\"", stdout);
+            test_h_escape(TEST_H_FORMAT_JUNIT, message ? message : "");
+            printf("\">%s.%s</failure></testcase>\n",
+                   suitedata->func, testdata->func);
+        } else if (todo) {
+            fputs("><skipped message=\"TODO\"/></testcase>\n", stdout);
+        } else if (message != NULL) {
+            fputs("><system-out>", stdout);
+            test_h_escape(TEST_H_FORMAT_JUNIT, message);
+            fputs("</system-out></testcase>\n", stdout);
+        } else {
+            fputs("/>\n", stdout);
+        }
+        break;
+    default:
+        if (global->silent) {
+            return;
+        }
+        if (failed && testdata->lineno > 0) {
+            printf(" FAILED at %s#L%d %s.%s: %s", file, testdata->lineno,
+                   suitedata->func, testdata->func, message);
+        } else if (failed) {
+            printf(" FAILED with %s", message);
+        } else if (todo) {
+            printf(" TODO");
+        } else {
+            printf(" %s", message != NULL ? message : "PASSED");
+        }
+        test_h_durations(global, &testdata->stats);
+        fflush(stdout);
+    }
+}
+
+/* a suite marked as TODO, which is not a test case */
+static void
+test_h_suite_todo(test_h_suitedata_t *suitedata)
+{
+    switch (suitedata->global->format) {
+    case TEST_H_FORMAT_JSONL:
+        fputs("{\"suite\":", stdout);
+        test_h_quote(suitedata->name);
+        printf(",\"case\":null,\"func\":\"%s\",\"status\":\"todo\"}\n",
+               suitedata->func);
+        break;
+    case TEST_H_FORMAT_TAP:
+        printf("# TODO %s -- ", suitedata->func);
+        test_h_escape(TEST_H_FORMAT_TAP, suitedata->name);
+        putchar('\n');
+        break;
+    case TEST_H_FORMAT_JUNIT:
+        /* no name, which may contain "--" not allowed in XML comments */
+        printf("<!-- TODO %s -->\n", suitedata->func);
+        break;
+    default:
+        printf("[TEST] %s -- %s ... TODO\n",
+               suitedata->func, suitedata->name);
+        fflush(stdout);
+    }
+}
+
+/*\
+ / A line of --list for a suite (with <suitedata> only) or a test case.
+\*/
+static void
+test_h_list(test_h_suitedata_t *suitedata, const char *kind,
+            const char *name, const char *func, const char *file, int line)
+{
+    if (name == NULL) {
+        printf("[SUITE] %s (%s at %s#L%d)\n",
+               suitedata->name, suitedata->func, file, line);
+    } else {
+        printf("[%s] %s : %s (%s at %s#L%d)\n",
+               kind, suitedata->name, name, func, file, line);
+    }
+}
+
+/*\
+ / The start of the output, before any test case.
+ /
+ / Records of the other formats are written through a buffer of
+ / TEST_H_BUFFER_SIZE bytes instead of being flushed line by line.
+\*/
+static void
+test_h_begin(test_h_globaldata_t *global)
+{
+    static char buffer[TEST_H_BUFFER_SIZE];
+
+    if (global->format != TEST_H_FORMAT_TEXT) {
+        setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    }
+    switch (global->format) {
+    case TEST_H_FORMAT_TAP:
+        printf("TAP version 13\n");
+        break;
+    case TEST_H_FORMAT_JUNIT:
+        printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<testsuites>\n<testsuite name=\"test.h\">\n");
+        break;
+    case TEST_H_FORMAT_TEXT:
+        if (!global->silent) {
+            printf("[INFO] Tests starting...\n");
+        }
+        break;
+    }
+}
+
+/* the end of the output with the counters and the time used in seconds */
+static void
+test_h_end(test_h_globaldata_t *global, double used)
+{
+    long seconds = (long)used;
+
+    switch (global->format) {
+    case TEST_H_FORMAT_JSONL:
+        printf("{\"total\":%d,\"passed\":%d,\"failed\":%d,\"todo\":%d,"
+               "\"duration_ms\":%.6f}\n", global->total, global->passed,
+               global->failed, global->todo, used * 1e3);
+        break;
+    case TEST_H_FORMAT_TAP:
+        printf("1..%d\n# Total / Passed / Failed: %d / %d / %d\n",
+               global->total + global->todo,
+               global->total, global->passed, global->failed);
+        break;
+    case TEST_H_FORMAT_JUNIT:
+        printf("</testsuite>\n</testsuites>\n");
+        break;
+    default:
+        if (!global->silent) {
+            printf("[INFO] Total / Passed / Failed: %d / %d / %d\n",
+                   global->total, global->passed, global->failed);
+            printf("[INFO] Time used: %ld minutes %ld.%06ld seconds\n",
+                   seconds / 60, seconds % 60,
+                   (long)((used - seconds) * 1e6));
+        }
+    }
+    fflush(stdout);
+}
+
+/* remember the last test case for --slowest <n> */
+static void
+test_h_collect(test_h_globaldata_t *global, const test_h_timing_t *timing)
+{
+    test_h_timing_t *p;
+    int n;
+
+    if (global->slowest <= 0 || timing->name == NULL) {
+        return;
+    }
+    if (global->timed == global->timings_size) {
+        n = global->timings_size ? global->timings_size * 2 : 64;
+        p = (test_h_timing_t *)realloc(global->timings,
+                                       sizeof(test_h_timing_t) * n);
+        if (p == NULL) {
+            TEST_H_ERROR_EXIT(realloc);
+        }
+        global->timings = p;
+        global->timings_size = n;
+    }
+    global->timings[global->timed++] = *timing;
+}
+
+static int
+test_h_compare_timings(const void *a, const void *b)
+{
+    double x = ((const test_h_timing_t *)a)->stats.wall;
+    double y = ((const test_h_timing_t *)b)->stats.wall;
+
+    return x > y ? -1 : x < y;
+}
+
+/* print the <n> slowest test cases remembered by test_h_collect */
+static void
+test_h_report_slowest(test_h_globaldata_t *global)
+{
+    /* not mixed into the records of other formats */
+    FILE *stream = global->format == TEST_H_FORMAT_TEXT ? stdout : stderr;
+    test_h_timing_t *p;
+    int i;
+
+    if (global->slowest <= 0) {
+        return;
+    }
+    qsort(global->timings, global->timed, sizeof(test_h_timing_t),
+          test_h_compare_timings);
+    fprintf(stream, "[INFO] Slowest %d of %d test cases:\n",
+           global->slowest < global->timed ? global->slowest : global->timed,
+           global->timed);
+    for (i = 0; i < global->slowest && i < global->timed; i += 1) {
+        p = global->timings + i;
+        fprintf(stream, "[SLOW] %10.3f ms, cpu %10.3f ms, faults %ld + %ld,"
+                " max rss %ld KiB : %s : %s\n",
+                p->stats.wall * 1e3, p->stats.cpu * 1e3,
+                p->stats.minflt, p->stats.majflt, p->stats.maxrss,
+                p->suite, p->name);
+    }
+    fflush(stream);
+    free(global->timings);
+    global->timings = NULL;
+    global->timed = global->timings_size = 0;
+}
+
+#ifdef TEST_H_JOBS
+static long
+test_h_tell(void)
+{
+    long offset;
+
+    fflush(stdout);
+    if ((offset = (long)lseek(STDOUT_FILENO, 0, SEEK_CUR)) < 0) {
+        TEST_H_ERROR_EXIT(lseek);
+    }
+    return offset;
+}
+
+static void
+test_h_record(test_h_globaldata_t *global, long kind, long start, long end)
+{
+    test_h_pool_t *pool = global->pool;
+    test_h_record_t record;
+    int fd = pool->files[pool->worker * 2 + 1];
+
+    memset(&record, 0, sizeof(record));
+    record.unit = pool->unit;
+    record.kind = kind;
+    record.start = start;
+    record.end = end;
+    record.worker = pool->worker;
+    if (kind != 0) {
+        record.total = global->total - pool->total;
+        record.passed = global->passed - pool->passed;
+        record.failed = global->failed - pool->failed;
+        record.todo = global->todo - pool->todo;
+        record.timing = global->last;
+    }
+    if (write(fd, &record, sizeof(record)) != (long)sizeof(record)) {
+        TEST_H_ERROR_EXIT(write);
+    }
+}
+
+/* a file in $TMPDIR that is gone once closed */
+static int
+test_h_tmpfile(int n)
+{
+    const char *dir = getenv("TMPDIR");
+    char *path;
+    int fd;
+
+    if (dir == NULL || *dir == '\0') {
+        dir = "/tmp";
+    }
+    if ((path = (char *)malloc(strlen(dir) + 64)) == NULL) {
+        TEST_H_ERROR_EXIT(malloc);
+    }
+    sprintf(path, "%s/test.h.%ld.%d", dir, (long)getpid(), n);
+    fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 || unlink(path) != 0) {
+        TEST_H_ERROR_EXIT(open);
+    }
+    free(path);
+    return fd;
+}
+
+static void
+test_h_fork(test_h_globaldata_t *global)
+{
+    test_h_pool_t *pool;
+    long next = 0;
+    int i, n = global->jobs;
+    pid_t pid;
+
+    pool = (test_h_pool_t *)malloc(sizeof(test_h_pool_t));
+    if (pool == NULL) {
+        TEST_H_ERROR_EXIT(malloc);
+    }
+    memset(pool, 0, sizeof(*pool));
+    pool->workers = n;
+    pool->files = (int *)malloc(sizeof(int) * n * 2);
+    pool->pids = (long *)malloc(sizeof(long) * n);
+    if (pool->files == NULL || pool->pids == NULL) {
+        TEST_H_ERROR_EXIT(malloc);
+    }
+    for (i = 0; i < n * 2; i += 1) {
+        pool->files[i] = test_h_tmpfile(i);
+    }
+    fflush(stdout);
+    if (pipe(pool->lock) != 0
+            || write(pool->lock[1], &next, sizeof(next)) != sizeof(next)
+            || (pool->saved = dup(STDOUT_FILENO)) < 0) {
+        TEST_H_ERROR_EXIT(pipe);
+    }
+    for (i = 1; i < n; i += 1) {
+        if ((pid = fork()) < 0) {
+            TEST_H_ERROR_EXIT(fork);
+        }
+        if (pid == 0) {
+            pool->worker = i;
+            break;
+        }
+        pool->pids[i] = (long)pid;
+    }
+    if (dup2(pool->files[pool->worker * 2], STDOUT_FILENO) < 0) {
+        TEST_H_ERROR_EXIT(dup2);
+    }
+    global->pool = pool;
+}
+#endif /* TEST_H_JOBS */
+
+/* whether this process shall run the next unit, see test_h_pool_t */
+static int
+test_h_claim(test_h_globaldata_t *global)
+{
+#ifdef TEST_H_JOBS
+    test_h_pool_t *pool;
+    long next, mark;
+    int mine;
+
+    global->last.name = NULL;
+    if (global->jobs < 2) {
+        return 1;
+    }
+    if (global->pool == NULL) {
+        test_h_fork(global);
+    }
+    pool = global->pool;
+    mark = test_h_tell();
+    if (pool->worker == 0 && mark > pool->mark) {
+        test_h_record(global, 0, pool->mark, mark);
+    }
+    pool->mark = mark;
+    if (read(pool->lock[0], &next, sizeof(next)) != sizeof(next)) {
+        TEST_H_ERROR_EXIT(read);
+    }
+    if ((mine = next <= pool->unit)) {
+        next = pool->unit + 1;
+    }
+    if (write(pool->lock[1], &next, sizeof(next)) != sizeof(next)) {
+        TEST_H_ERROR_EXIT(write);
+    }
+    if (!mine) {
+        pool->unit += 1;
+    }
+    pool->total = global->total;
+    pool->passed = global->passed;
+    pool->failed = global->failed;
+    pool->todo = global->todo;
+    return mine;
+#else
+    global->last.name = NULL;
+    return 1;
+#endif
+}
+
+/* the end of a unit claimed by test_h_claim */
+static void
+test_h_release(test_h_globaldata_t *global)
+{
+#ifdef TEST_H_JOBS
+    test_h_pool_t *pool = global->pool;
+    long mark;
+
+    if (pool != NULL) {
+        mark = test_h_tell();
+        test_h_record(global, 1, pool->mark, mark);
+        pool->mark = mark;
+        pool->unit += 1;
+    }
+#else
+    (void)global;
+#endif
+}
+
+#ifdef TEST_H_JOBS
+/* the name of a signal that terminated an isolated test case */
+static const char *
+test_h_signal(int sig)
+{
+    static char name[32];
+
+    switch (sig) {
+    case SIGABRT: return "SIGABRT";
+    case SIGALRM: return "SIGALRM";
+    case SIGFPE: return "SIGFPE";
+    case SIGILL: return "SIGILL";
+    case SIGINT: return "SIGINT";
+    case SIGSEGV: return "SIGSEGV";
+    case SIGTERM: return "SIGTERM";
+#ifdef SIGBUS
+    case SIGBUS: return "SIGBUS";
+#endif
+#ifdef SIGKILL
+    case SIGKILL: return "SIGKILL";
+#endif
+#ifdef SIGPIPE
+    case SIGPIPE: return "SIGPIPE";
+#endif
+#ifdef SIGTRAP
+    case SIGTRAP: return "SIGTRAP";
+#endif
+    }
+    sprintf(name, "signal %d", sig);
+    return name;
+}
+#endif /* TEST_H_JOBS */
+
+/*\
+ / Fork the process for a test case to run in with --isolate.
+ /
+ / Return 1 in the child, or when not isolated, to run the test case.  The
+ / child passes the flags of the suite through its exit status, and a
+ / crash or a timeout of the child is reported as a failure instead.
+\*/
+static int
+test_h_isolate(test_h_suitedata_t *suitedata, const char *func)
+{
+#ifdef TEST_H_JOBS
+    test_h_globaldata_t *global = suitedata->global;
+    test_h_testdata_t testdata;
+    test_h_timing_t timing;
+    char message[64];
+    pid_t pid;
+    int status, fds[2];
+    long n;
+
+    if (!global->isolate) {
+        return 1;
+    }
+    fflush(stdout);
+    test_h_usage(&timing.stats);
+    if (pipe(fds) != 0) {
+        TEST_H_ERROR_EXIT(pipe);
+    }
+    if ((pid = fork()) < 0) {
+        TEST_H_ERROR_EXIT(fork);
+    }
+    if (pid == 0) {
+        global->child = fds[1];
+        close(fds[0]);
+        signal(SIGALRM, SIG_DFL);
+        alarm(global->timeout);
+        return 1;
+    }
+    close(fds[1]);
+    n = (long)read(fds[0], &global->last, sizeof(global->last));
+    close(fds[0]);
+    if (waitpid(pid, &status, 0) < 0) {
+        TEST_H_ERROR_EXIT(waitpid);
+    }
+    /* the timing of the test case, unless the child crashed */
+    if (n != (long)sizeof(global->last)) {
+        test_h_since(&timing.stats);
+        timing.suite = suitedata->name;
+        timing.name = NULL;
+        global->last = timing;
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) >= 64
+            && WEXITSTATUS(status) < 64 + 8) {
+        suitedata->flags |= WEXITSTATUS(status) - 64;
+        return 0;
+    }
+    /* the test case was cut off after "[TEST] suite : case ..." */
+    suitedata->flags |= TEST_H_FAILED;
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        sprintf(message, "SIGALRM after %d seconds", global->timeout);
+    } else if (WIFSIGNALED(status)) {
+        sprintf(message, "%.32s", test_h_signal(WTERMSIG(status)));
+    } else {
+        sprintf(message, "exit status %d", WEXITSTATUS(status));
+    }
+    memset(&testdata, 0, sizeof(testdata));
+    testdata.name = func;
+    testdata.func = func;
+    testdata.flags = TEST_H_FAILED;
+    testdata.message = message;
+    testdata.stats = global->last.stats;
+    test_h_result(suitedata, &testdata, NULL, NULL);
+    return 0;
+#else
+    (void)suitedata;
+    (void)func;
+    return 1;
+#endif
+}
+
+/* the end of the child process of test_h_isolate with its timing */
+static void
+test_h_isolated(test_h_suitedata_t *suitedata)
+{
+#ifdef TEST_H_JOBS
+    test_h_globaldata_t *global = suitedata->global;
+
+    if (global->child) {
+        fflush(stdout);
+        if (global->last.name != NULL) {
+            if (write(global->child, &global->last, sizeof(global->last))
+                    != (long)sizeof(global->last)) {
+                _exit(EXIT_FAILURE);
+            }
+        }
+        _exit(64 + (suitedata->flags & 7));
+    }
+#else
+    (void)suitedata;
+#endif
+}
+
+#ifdef TEST_H_JOBS
+static int
+test_h_compare_records(const void *a, const void *b)
+{
+    const test_h_record_t *x = (const test_h_record_t *)a;
+    const test_h_record_t *y = (const test_h_record_t *)b;
+
+    if (x->unit != y->unit) {
+        return x->unit < y->unit ? -1 : 1;
+    }
+    return x->kind < y->kind ? -1 : x->kind > y->kind;
+}
+
+/* copy the range of output of a unit into stdout */
+static void
+test_h_copy(int fd, long start, long end)
+{
+    char buffer[4096];
+    long n, size = (long)sizeof(buffer);
+
+    if (lseek(fd, start, SEEK_SET) != start) {
+        TEST_H_ERROR_EXIT(lseek);
+    }
+    for (; start < end; start += n) {
+        n = end - start < size ? end - start : size;
+        if ((n = (long)read(fd, buffer, n)) <= 0) {
+            TEST_H_ERROR_EXIT(read);
+        }
+        fwrite(buffer, 1, n, stdout);
+    }
+}
+#endif /* TEST_H_JOBS */
+
+/*\
+ / Wait for the worker processes after test_h_main, if any.
+ /
+ / The workers exit here.  The parent merges their output in the order of
+ / units into stdout and their counters into <global>.
+\*/
+static void
+test_h_join(test_h_globaldata_t *global)
+{
+#ifdef TEST_H_JOBS
+    test_h_pool_t *pool = global->pool;
+    test_h_record_t *records = NULL;
+    long i, n = 0, size, mark;
+    int fd, status;
+
+    if (pool == NULL) {
+        return;
+    }
+    mark = test_h_tell();
+    if (pool->worker != 0) {
+        exit(EXIT_SUCCESS);
+    }
+    if (mark > pool->mark) {
+        test_h_record(global, 0, pool->mark, mark);
+    }
+    if (dup2(pool->saved, STDOUT_FILENO) < 0) {
+        TEST_H_ERROR_EXIT(dup2);
+    }
+    for (i = 1; i < pool->workers; i += 1) {
+        if (waitpid((pid_t)pool->pids[i], &status, 0) < 0) {
+            TEST_H_ERROR_EXIT(waitpid);
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            fprintf(stderr, "\n[ERROR] worker #%ld terminated abnormally\n",
+                    i);
+            global->failed += 1;
+        }
+    }
+    for (i = 0; i < pool->workers; i += 1) {
+        fd = pool->files[i * 2 + 1];
+        if ((size = (long)lseek(fd, 0, SEEK_END)) < 0) {
+            TEST_H_ERROR_EXIT(lseek);
+        }
+        size /= sizeof(test_h_record_t);
+        records = (test_h_record_t *)realloc(records,
+                sizeof(test_h_record_t) * (n + size + 1));
+        if (records == NULL || lseek(fd, 0, SEEK_SET) != 0) {
+            TEST_H_ERROR_EXIT(realloc);
+        }
+        size *= sizeof(test_h_record_t);
+        if (read(fd, records + n, size) != size) {
+            TEST_H_ERROR_EXIT(read);
+        }
+        for (size = n + size / sizeof(test_h_record_t); n < size; n += 1) {
+            /* the parent has its own counters */
+            if (i != 0) {
+                global->total += records[n].total;
+                global->passed += records[n].passed;
+                global->failed += records[n].failed;
+                global->todo += records[n].todo;
+                test_h_collect(global, &records[n].timing);
+            }
+        }
+    }
+    qsort(records, n, sizeof(test_h_record_t), test_h_compare_records);
+    for (i = 0; i < n; i += 1) {
+        test_h_copy(pool->files[records[i].worker * 2],
+                    records[i].start, records[i].end);
+    }
+    fflush(stdout);
+    for (i = 0; i < pool->workers * 2; i += 1) {
+        close(pool->files[i]);
+    }
+    close(pool->lock[0]);
+    close(pool->lock[1]);
+    close(pool->saved);
+    free(records);
+    free(pool->files);
+    free(pool->pids);
+    free(pool);
+    global->pool = NULL;
+#else
+    (void)global;
+#endif
+}
+
+/*\
+ / The time stamp counter for cycles per iteration, or -1 if none.
+\*/
+static double
+test_h_ticks(void)
+{
+#if (defined(__GNUC__) || defined(__clang__)) \
+        && (defined(__x86_64__) || defined(__i386__))
+    return (double)__builtin_ia32_rdtsc();
+#else
+    return -1;
+#endif
+}
+
+/*\
+ / Drive the BENCH loop: return 1 to run another sample of .n iterations.
+ /
+ / The number of iterations is scaled up until one sample takes about
+ / 1/TEST_H_BENCH_SAMPLES of --bench-time, which also warms up the code and
+ / the caches; then TEST_H_BENCH_SAMPLES samples are taken.
+\*/
+static TEST_H_MAYBE_UNUSED int
+test_h_bench_next(test_h_bench_t *bench)
+{
+    double now = test_h_now(), ticks = test_h_ticks(), used, scale;
+
+    used = now - bench->start;
+    if (bench->phase == 0) {
+        bench->phase = 1;
+        bench->n = 1;
+    } else if (bench->phase == 1) {
+        if (used < bench->target && bench->n < (1L << 30)) {
+            /* aim a bit beyond the target with at most 10 times more */
+            scale = used > 0 ? bench->target * 1.2 / used : 10;
+            scale = scale < 2 ? 2 : scale > 10 ? 10 : scale;
+            bench->n = (long)(bench->n * scale);
+        } else {
+            bench->phase = 2;
+        }
+    } else {
+        bench->ns[bench->count] = used * 1e9 / bench->n;
+        bench->cycles[bench->count] = ticks < 0 ? -1
+                                    : (ticks - bench->ticks) / bench->n;
+        if (++bench->count == TEST_H_BENCH_SAMPLES) {
+            return 0;
+        }
+    }
+    bench->i = bench->n;
+    bench->start = test_h_now();
+    bench->ticks = test_h_ticks();
+    return 1;
+}
+
+static int
+test_h_compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* the median of sorted <x> */
+static double
+test_h_median(const double *x, int n)
+{
+    return n % 2 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2;
+}
+
+/* write min, median, p99 and MAD in ns/op, and median cycles/op */
+static TEST_H_MAYBE_UNUSED void
+test_h_bench_report(test_h_bench_t *bench, char *report)
+{
+    double deviations[TEST_H_BENCH_SAMPLES], median;
+    int i, n = bench->count;
+
+    if (n == 0) {
+        strcpy(report, "no BENCH loop");
+        return;
+    }
+    qsort(bench->ns, n, sizeof(double), test_h_compare_doubles);
+    qsort(bench->cycles, n, sizeof(double), test_h_compare_doubles);
+    median = test_h_median(bench->ns, n);
+    for (i = 0; i < n; i += 1) {
+        deviations[i] = bench->ns[i] > median ? bench->ns[i] - median
+                                              : median - bench->ns[i];
+    }
+    qsort(deviations, n, sizeof(double), test_h_compare_doubles);
+    /* the nearest rank for p99 */
+    report += sprintf(report, "%.2f ns/op (min %.2f, p99 %.2f, MAD %.2f",
+                      median, bench->ns[0],
+                      bench->ns[(n * 99 + 99) / 100 - 1],
+                      test_h_median(deviations, n));
+    if (bench->cycles[0] >= 0) {
+        report += sprintf(report, ", %.1f cycles/op",
+                          test_h_median(bench->cycles, n));
+    }
+    sprintf(report, ", %d x %ld)", n, bench->n);
+}
+
+/*\
+ / Pin the process and raise its scheduling class for a benchmark, as far
+ / as permitted, and then restore them with <restore> set.
+ /
+ / Pinning needs sched_setaffinity, e.g. with _GNU_SOURCE on Linux.
+\*/
+static TEST_H_MAYBE_UNUSED void
+test_h_bench_setup(test_h_globaldata_t *global, int restore)
+{
+#ifdef TEST_H_JOBS
+    static struct sched_param param;
+    static int policy = -1;
+    struct sched_param fifo;
+#ifdef CPU_SET
+    static cpu_set_t mask;
+    static int pinned;
+    cpu_set_t cpu;
+
+    if (restore) {
+        if (pinned) {
+            sched_setaffinity(0, sizeof(mask), &mask);
+        }
+        pinned = 0;
+    } else if (global->pin > 0) {
+        CPU_ZERO(&cpu);
+        CPU_SET(global->pin - 1, &cpu);
+        pinned = sched_getaffinity(0, sizeof(mask), &mask) == 0
+              && sched_setaffinity(0, sizeof(cpu), &cpu) == 0;
+        if (!pinned) {
+            fprintf(stderr, "[WARN] failed to pin to CPU %d\n",
+                    global->pin - 1);
+        }
+    }
+#else
+    if (!restore && global->pin > 0) {
+        fprintf(stderr, "[WARN] no support for pinning to a CPU\n");
+    }
+#endif
+    if (restore) {
+        if (policy >= 0) {
+            sched_setscheduler(0, policy, &param);
+        }
+        policy = -1;
+    } else if (global->fifo) {
+        fifo.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        if ((policy = sched_getscheduler(0)) < 0
+                || sched_getparam(0, &param) != 0
+                || sched_setscheduler(0, SCHED_FIFO, &fifo) != 0) {
+            fprintf(stderr, "[WARN] failed to run under SCHED_FIFO\n");
+            policy = -1;
+        }
+    }
+#else
+    if (!restore && (global->pin > 0 || global->fifo)) {
+        fprintf(stderr, "[WARN] no support for --pin and --fifo\n");
+    }
+#endif
+}
+
+/* whether <s> matches the glob <p> with * and ? */
+static int
+test_h_glob(const char *p, const char *s)
+{
+    const char *star = NULL, *back = NULL;
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+    while (*s != '\0') {
+        if (*p == '*') {
+            star = ++p;
+            back = s;
+        } else if (*p == *s || *p == '?') {
+            p += 1;
+            s += 1;
+        } else if (star != NULL) {
+            /* let the last star take one more character */
+            p = star;
+            s = ++back;
+        } else {
+            return 0;
+        }
+    }
+    while (*p == '*') {
+        p += 1;
+    }
+    return *p == '\0';
+}
 
-#define TEST_H_NONE         0
-#define TEST_H_FAILED       1
-#define TEST_H_FILTERED     2
-#define TEST_H_TODO         4
+/* whether <p> matches either name, or NULL as a wildcard */
+static int
+test_h_match(const char *p, int glob, const char *name1, const char *name2)
+{
+    if (p == NULL) {
+        return 1;
+    }
+    if (glob) {
+        return test_h_glob(p, name1) || test_h_glob(p, name2);
+    }
+    return test_h_str_eq(p, name1) || test_h_str_eq(p, name2);
+}
 
-typedef struct test_h_filter {
-    const char *suite;
-    const char *test;
-    struct test_h_filter *next;
-} test_h_filter_t;
+/*\
+ / Keys of the hash of exact names, which is indexed by FNV-1a:
+ /
+ /   TEST_H_KEY_CASE   (suite or NULL, test case or NULL) of an include
+ /   TEST_H_KEY_SUITE  (suite, *) for any include in the suite
+ /   TEST_H_KEY_SKIP   (NULL, test case) of an exclude
+\*/
+#define TEST_H_KEY_CASE     1
+#define TEST_H_KEY_SUITE    2
+#define TEST_H_KEY_SKIP     3
 
-typedef struct test_h_globaldata {
-    int total;
-    int passed;
-    int failed;
-    int silent;
-    test_h_filter_t filter;
-} test_h_globaldata_t;
+static unsigned long
+test_h_hash(int key, const char *suite, const char *test)
+{
+    unsigned long h = 2166136261UL ^ (unsigned long)key;
 
-typedef struct test_h_suitedata {
-    const char *name;
-    const char *func;
-    int flags;
-    void *userdata;
-    test_h_globaldata_t *global;
-} test_h_suitedata_t;
+    h = (h * 16777619UL) & 0xFFFFFFFFUL;
+    while (suite != NULL && *suite != '\0') {
+        h = ((h ^ (unsigned char)*suite++) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    /* (NULL, "a") differs from ("", "a") by the separator */
+    h = ((h ^ (suite == NULL ? 1UL : 0UL)) * 16777619UL) & 0xFFFFFFFFUL;
+    while (test != NULL && *test != '\0') {
+        h = ((h ^ (unsigned char)*test++) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return h;
+}
 
-typedef struct test_h_testdata {
-    const char *name;
-    const char *func;
-    int flags;
-    int lineno;
-    const char *message;
-    void *userdata;
-} test_h_testdata_t;
+static int
+test_h_same(const char *a, const char *b)
+{
+    return a == NULL ? b == NULL : b != NULL && test_h_str_eq(a, b);
+}
 
-#define TEST_H_ERROR_EXIT(x) \
-    do { \
-        fflush(stdout); \
-        fprintf(stderr, "\n[ERROR] %s#L%d %s\n", __FILE__, __LINE__, #x); \
-        exit(EXIT_FAILURE); \
-    } while (0)
+/* the slot of the key in the hash, which is empty if not found */
+static long
+test_h_lookup(const test_h_filter_t *filter,
+              int key, const char *suite, const char *test)
+{
+    const test_h_pattern_t *p;
+    long i = (long)(test_h_hash(key, suite, test) & filter->mask), e;
+
+    while ((e = filter->index[i]) != 0) {
+        p = filter->patterns + (e >> 2);
+        if ((e & 3) == key && test_h_same(p->suite, suite)
+                && (key == TEST_H_KEY_SUITE || test_h_same(p->test, test))) {
+            break;
+        }
+        i = (i + 1) & filter->mask;
+    }
+    return i;
+}
 
 static int
-test_h_str_eq(const char *a, const char *b)
+test_h_found(const test_h_filter_t *filter,
+             int key, const char *suite, const char *test)
 {
-    return strcmp(a, b) == 0;
+    return filter->index[test_h_lookup(filter, key, suite, test)] != 0;
+}
+
+static void
+test_h_insert(test_h_filter_t *filter, int key, int pattern)
+{
+    test_h_pattern_t *p = filter->patterns + pattern;
+    long i = test_h_lookup(filter, key, p->suite,
+                           key == TEST_H_KEY_SUITE ? NULL : p->test);
+
+    if (filter->index[i] == 0) {
+        filter->index[i] = ((long)pattern << 2) | key;
+    }
+}
+
+/* build the index of the filter, see test_h_filter_t */
+static void
+test_h_compile_filter(test_h_filter_t *filter)
+{
+    test_h_pattern_t *p;
+    long size = 16;
+    int i;
+
+    while (size < (long)filter->count * 4) {
+        size *= 2;
+    }
+    filter->index = (long *)calloc(size + filter->count + 1, sizeof(long));
+    if (filter->index == NULL) {
+        TEST_H_ERROR_EXIT(calloc);
+    }
+    filter->mask = size - 1;
+    filter->globs = 0;
+    for (i = 0; i < filter->count; i += 1) {
+        p = filter->patterns + i;
+        if (!p->exclude && p->suite != NULL
+                && strpbrk(p->suite, "*?") == NULL) {
+            test_h_insert(filter, TEST_H_KEY_SUITE, i);
+        }
+        if (p->glob) {
+            filter->index[size + filter->globs++] = i;
+        } else {
+            test_h_insert(filter, p->exclude ? TEST_H_KEY_SKIP
+                                             : TEST_H_KEY_CASE, i);
+        }
+    }
 }
 
+/*\
+ / Whether to run the suite (test1 and test2 NULL) or the test case.
+ /
+ / A suite runs if any test case in it may be selected.  A test case runs
+ / if selected by a pattern of its suite, or of any suite, or if there is
+ / no -s or -c at all, unless it matches any -x.
+\*/
 static int
 test_h_filter_testcase(test_h_filter_t *filter,
                        const char *suite1, const char *suite2,
                        const char *test1, const char *test2)
 {
-    int no_filter = filter->next == NULL;
+    const test_h_pattern_t *p;
+    const long *globs;
+    int i, selected = 1;
 
     if ((suite1 == NULL || suite2 == NULL)
             || (test1 == NULL && test2 != NULL)
             || (test1 != NULL && test2 == NULL)) {
         TEST_H_ERROR_EXIT(test_h_filter_testcase);
     }
-    while ((filter = filter->next) != NULL) {
-        if (filter->suite == NULL && filter->test == NULL) {
-            TEST_H_ERROR_EXIT(test_h_filter_testcase);
-        }
-        if (filter->suite != NULL) {
-            if (test_h_str_eq(filter->suite, suite1)
-                    || test_h_str_eq(filter->suite, suite2)) {
-                if (filter->test == NULL
-                        || test1 == NULL
-                        || test_h_str_eq(filter->test, test1)
-                        || test2 == NULL
-                        || test_h_str_eq(filter->test, test2)) {
-                    return 1;
-                }
-            }
-        } else if (filter->test != NULL) {
-            if (test1 == NULL
-                    || test_h_str_eq(filter->test, test1)
-                    || test2 == NULL
-                    || test_h_str_eq(filter->test, test2)) {
+    if (filter->count == 0) {
+        return 1;
+    }
+    if (filter->index == NULL) {
+        test_h_compile_filter(filter);
+    }
+    globs = filter->index + filter->mask + 1;
+    if (test1 == NULL) {
+        if (filter->includes == 0 || filter->anycase
+                || test_h_found(filter, TEST_H_KEY_SUITE, suite1, NULL)
+                || test_h_found(filter, TEST_H_KEY_SUITE, suite2, NULL)) {
+            return 1;
+        }
+        for (i = 0; i < filter->globs; i += 1) {
+            p = filter->patterns + globs[i];
+            if (!p->exclude && test_h_match(p->suite, 1, suite1, suite2)) {
                 return 1;
             }
         }
+        return 0;
+    }
+    if (filter->includes > 0) {
+        selected = test_h_found(filter, TEST_H_KEY_CASE, suite1, NULL)
+                || test_h_found(filter, TEST_H_KEY_CASE, suite2, NULL)
+                || test_h_found(filter, TEST_H_KEY_CASE, suite1, test1)
+                || test_h_found(filter, TEST_H_KEY_CASE, suite1, test2)
+                || test_h_found(filter, TEST_H_KEY_CASE, suite2, test1)
+                || test_h_found(filter, TEST_H_KEY_CASE, suite2, test2)
+                || test_h_found(filter, TEST_H_KEY_CASE, NULL, test1)
+                || test_h_found(filter, TEST_H_KEY_CASE, NULL, test2);
+    }
+    if (test_h_found(filter, TEST_H_KEY_SKIP, NULL, test1)
+            || test_h_found(filter, TEST_H_KEY_SKIP, NULL, test2)) {
+        return 0;
+    }
+    for (i = 0; i < filter->globs; i += 1) {
+        p = filter->patterns + globs[i];
+        if (p->exclude) {
+            if (test_h_match(p->test, 1, test1, test2)) {
+                return 0;
+            }
+        } else if (!selected) {
+            selected = test_h_match(p->suite, 1, suite1, suite2)
+                    && test_h_match(p->test, 1, test1, test2);
+        }
+    }
+    return selected;
+}
+
+/*\
+ / Whether the test case (or the TODO note of a suite with <test> NULL) is in
+ / the shard of --shard-index, by a hash of the functions.  The hash does not
+ / depend on the platform, the build or the other test cases, so that every
+ / test case runs in exactly one of --shard-count processes or machines.
+\*/
+static int
+test_h_in_shard(test_h_globaldata_t *global,
+                const char *suite, const char *test)
+{
+    return global->shards < 2
+        || (long)(test_h_hash(0, suite, test) % global->shards)
+           == global->shard;
+}
+
+static test_h_pattern_t *
+test_h_add_pattern(test_h_filter_t *filter,
+                   const char *suite, const char *test, int exclude)
+{
+    test_h_pattern_t *p;
+    int n;
+
+    if (filter->count == filter->size) {
+        n = filter->size ? filter->size * 2 : 16;
+        p = (test_h_pattern_t *)realloc(filter->patterns,
+                                        sizeof(test_h_pattern_t) * n);
+        if (p == NULL) {
+            fprintf(stderr, "\n[ERROR] failed to allocate memory\n");
+            exit(EXIT_FAILURE);
+        }
+        filter->patterns = p;
+        filter->size = n;
+    }
+    /* compiled again on the next check */
+    free(filter->index);
+    filter->index = NULL;
+    p = filter->patterns + filter->count++;
+    p->suite = suite;
+    p->test = test;
+    p->exclude = exclude;
+    p->glob = (suite != NULL && strpbrk(suite, "*?") != NULL)
+           || (test != NULL && strpbrk(test, "*?") != NULL);
+    return p;
+}
+
+/* select test cases by -s <suite> or -c <case>, or both */
+static TEST_H_MAYBE_UNUSED test_h_filter_t *
+test_h_add_filter(test_h_filter_t *filter,
+                  const char *suite,
+                  const char *test)
+{
+    if (suite != NULL || test != NULL) {
+        test_h_add_pattern(filter, suite, test, 0);
+        filter->includes += 1;
+        filter->anycase += suite == NULL;
+    }
+    return filter;
+}
+
+/* skip test cases by -x <case> even if selected */
+static TEST_H_MAYBE_UNUSED void
+test_h_add_exclude(test_h_filter_t *filter, const char *test)
+{
+    test_h_add_pattern(filter, NULL, test, 1);
+}
+
+#ifdef TEST_H_AUTO
+/*\
+ / --list by walking test_h_registry in the order of definition, so that
+ / neither TEST_MAIN nor the body of any suite runs.
+ /
+ / Which suites run a test case is only known from their bodies, so a test
+ / case is listed without a suite, if any selected suite may run it.
+\*/
+static __attribute__((unused)) void
+test_h_list_all(test_h_globaldata_t *global)
+{
+    test_h_entry_t *entry, *suite;
+
+    for (entry = test_h_registry; entry != NULL; entry = entry->next) {
+        for (suite = test_h_registry; suite != NULL; suite = suite->next) {
+            if (suite->suite == NULL
+                    || !test_h_filter_testcase(&global->filter,
+                                               suite->func, suite->name,
+                                               NULL, NULL)) {
+                continue;
+            }
+            if (entry->suite != NULL
+                    ? entry == suite
+                    : test_h_filter_testcase(&global->filter,
+                                             suite->func, suite->name,
+                                             entry->func, entry->name)
+                      && test_h_in_shard(global, suite->func, entry->func)) {
+                printf("[%s] %s (%s at %s#L%d)\n", entry->kind,
+                       entry->name, entry->func, entry->file, entry->line);
+                break;
+            }
+        }
     }
-    return no_filter;
 }
+#endif /* TEST_H_AUTO */
 
 #define TEST_SUITE(suitename, fn) \
     static void test_h_suite_ ## fn(test_h_suitedata_t *test_h_context); \
+    static void fn(test_h_globaldata_t *globaldata, void *userdata); \
+    TEST_H_REGISTER("SUITE", suitename, fn, fn, NULL) \
     static void fn(test_h_globaldata_t *globaldata, void *userdata) \
     { \
         test_h_suitedata_t suitedata; \
@@ -206,11 +1729,19 @@ test_h_filter_testcase(test_h_filter_t *filter,
         suitedata.flags = TEST_H_NONE; \
         suitedata.userdata = userdata; \
         suitedata.global = globaldata; \
+        if (globaldata->list) { \
+            test_h_list(&suitedata, "SUITE", NULL, NULL, \
+                        __FILE__, __LINE__); \
+            test_h_suite_ ## fn(&suitedata); \
+            return; \
+        } \
         test_h_suite_ ## fn(&suitedata); \
-        if (suitedata.flags & TEST_H_TODO) { \
-            printf("[TEST] %s -- %s ... TODO\n", \
-                    suitedata.func, suitedata.name); \
-            fflush(stdout); \
+        if (test_h_claim(globaldata)) { \
+            if ((suitedata.flags & TEST_H_TODO) \
+                    && test_h_in_shard(globaldata, #fn, NULL)) { \
+                test_h_suite_todo(&suitedata); \
+            } \
+            test_h_release(globaldata); \
         } \
     } \
     static void test_h_suite_ ## fn(test_h_suitedata_t *test_h_context) \
@@ -218,12 +1749,22 @@ test_h_filter_testcase(test_h_filter_t *filter,
 
 #define TEST_CASE(testname, fn) \
     static void test_h_test_ ## fn(test_h_testdata_t *test_h_context); \
+    static void fn(test_h_suitedata_t *suitedata, void *userdata); \
+    TEST_H_REGISTER("TEST", testname, fn, NULL, fn) \
     static void fn(test_h_suitedata_t *suitedata, void *userdata) \
     { \
         test_h_testdata_t testdata; \
         if (!test_h_filter_testcase(&suitedata->global->filter, \
                                     suitedata->func, suitedata->name, \
-                                    #fn, testname)) { \
+                                    #fn, testname) \
+                || !test_h_in_shard(suitedata->global, \
+                                    suitedata->func, #fn)) { \
+            suitedata->flags |= TEST_H_FILTERED; \
+            return; \
+        } \
+        if (suitedata->global->list) { \
+            test_h_list(suitedata, "TEST", testname, #fn, \
+                        __FILE__, __LINE__); \
             suitedata->flags |= TEST_H_FILTERED; \
             return; \
         } \
@@ -233,27 +1774,109 @@ test_h_filter_testcase(test_h_filter_t *filter,
         testdata.lineno = 0; \
         testdata.message = NULL; \
         testdata.userdata = userdata; \
-        if (!suitedata->global->silent) { \
+        testdata.bench = NULL; \
+        if (!suitedata->global->silent \
+                && suitedata->global->format == TEST_H_FORMAT_TEXT) { \
             printf("[TEST] %s : %s ...", suitedata->name, testdata.name); \
             fflush(stdout); \
         } \
+        test_h_usage(&testdata.stats); \
         test_h_test_ ## fn(&testdata); \
+        test_h_since(&testdata.stats); \
         suitedata->flags |= (testdata.flags & (TEST_H_FAILED|TEST_H_TODO)); \
-        if (!suitedata->global->silent) { \
-            if (testdata.flags & TEST_H_FAILED) { \
-                printf(" FAILED at %s#L%d %s.%s: %s\n", \
-                        __FILE__, testdata.lineno, \
-                        suitedata->func, testdata.func, testdata.message); \
-            } else if (testdata.flags & TEST_H_TODO) { \
-                printf(" TODO\n"); \
-            } else { \
-                printf(" PASSED\n"); \
-            } \
+        suitedata->global->last.suite = suitedata->name; \
+        suitedata->global->last.name = testdata.name; \
+        suitedata->global->last.stats = testdata.stats; \
+        test_h_result(suitedata, &testdata, __FILE__, NULL); \
+    } \
+    static void test_h_test_ ## fn(test_h_testdata_t *test_h_context) \
+    /* { body: ASSERT(yes); } */
+
+/*\
+ / A benchmark, which is a test case with a BENCH loop run by --bench only.
+ /
+ /     BENCH_CASE("sum", bench_sum) {
+ /         int i, sum = 0;
+ /         BENCH {
+ /             for (i = 0; i < 100; i++) {
+ /                 sum += i;
+ /             }
+ /             BENCH_KEEP(sum);
+ /         }
+ /         ASSERT(sum != 0);
+ /     }
+\*/
+#define BENCH_CASE(benchname, fn) \
+    static void test_h_test_ ## fn(test_h_testdata_t *test_h_context); \
+    static void fn(test_h_suitedata_t *suitedata, void *userdata); \
+    TEST_H_REGISTER("BENCH", benchname, fn, NULL, fn) \
+    static void fn(test_h_suitedata_t *suitedata, void *userdata) \
+    { \
+        test_h_testdata_t testdata; \
+        test_h_bench_t bench; \
+        char report[256]; \
+        if (!(suitedata->global->bench || suitedata->global->list) \
+                || !test_h_filter_testcase(&suitedata->global->filter, \
+                                           suitedata->func, suitedata->name, \
+                                           #fn, benchname) \
+                || !test_h_in_shard(suitedata->global, \
+                                    suitedata->func, #fn)) { \
+            suitedata->flags |= TEST_H_FILTERED; \
+            return; \
+        } \
+        if (suitedata->global->list) { \
+            test_h_list(suitedata, "BENCH", benchname, #fn, \
+                        __FILE__, __LINE__); \
+            suitedata->flags |= TEST_H_FILTERED; \
+            return; \
+        } \
+        testdata.name = benchname; \
+        testdata.func = #fn; \
+        testdata.flags = TEST_H_NONE; \
+        testdata.lineno = 0; \
+        testdata.message = NULL; \
+        testdata.userdata = userdata; \
+        testdata.bench = &bench; \
+        memset(&bench, 0, sizeof(bench)); \
+        bench.target = suitedata->global->bench_time / 1e3 \
+                     / TEST_H_BENCH_SAMPLES; \
+        if (!suitedata->global->silent \
+                && suitedata->global->format == TEST_H_FORMAT_TEXT) { \
+            printf("[BENCH] %s : %s ...", suitedata->name, testdata.name); \
             fflush(stdout); \
         } \
+        test_h_bench_setup(suitedata->global, 0); \
+        test_h_usage(&testdata.stats); \
+        test_h_test_ ## fn(&testdata); \
+        test_h_since(&testdata.stats); \
+        test_h_bench_setup(suitedata->global, 1); \
+        suitedata->flags |= (testdata.flags & (TEST_H_FAILED|TEST_H_TODO)); \
+        suitedata->global->last.suite = suitedata->name; \
+        suitedata->global->last.name = testdata.name; \
+        suitedata->global->last.stats = testdata.stats; \
+        test_h_bench_report(&bench, report); \
+        test_h_result(suitedata, &testdata, __FILE__, report); \
     } \
     static void test_h_test_ ## fn(test_h_testdata_t *test_h_context) \
-    /* { body: ASSERT(yes); } */
+    /* { body: ...; BENCH { ...; BENCH_KEEP(result); } ... } */
+
+/*\
+ / The timed loop of a BENCH_CASE, run as many times as needed.
+\*/
+#define BENCH \
+    /* test_h_testdata_t *test_h_context */ \
+    while (test_h_bench_next(test_h_context->bench)) \
+        while (test_h_context->bench->i-- > 0)
+
+/*\
+ / Keep the compiler from optimizing away <x> or the code computing it.
+\*/
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_KEEP(x) __asm__ __volatile__("" : : "r,m"(x) : "memory")
+#else
+static const volatile void *volatile test_h_sink;
+#define BENCH_KEEP(x) (test_h_sink = (const volatile void *)&(x))
+#endif
 
 #define TODO \
     do { \
@@ -298,15 +1921,36 @@ test_h_filter_testcase(test_h_filter_t *filter,
 #define TEST(fn_test, userdata) \
     /* test_h_suitedata_t *test_h_context */ \
     do { \
-        fn_test(test_h_context, userdata); \
-        /* flags passed from test_h_testdata */ \
-        if (!(test_h_context->flags & (TEST_H_FILTERED|TEST_H_TODO))) { \
-            test_h_context->global->total += 1; \
-            if (test_h_context->flags & TEST_H_FAILED) { \
-                test_h_context->global->failed += 1; \
+        if (test_h_context->global->list) { \
+            fn_test(test_h_context, userdata); \
+        } else if (test_h_claim(test_h_context->global)) { \
+            if (test_h_isolate(test_h_context, #fn_test)) { \
+                fn_test(test_h_context, userdata); \
+                test_h_isolated(test_h_context); \
+            } \
+            if (test_h_context->flags & (TEST_H_FILTERED|TEST_H_TODO)) { \
+                test_h_context->global->last.name = NULL; \
+            } else { \
+                if (test_h_context->global->last.name == NULL) { \
+                    test_h_context->global->last.name = #fn_test; \
+                } \
+                test_h_collect(test_h_context->global, \
+                               &test_h_context->global->last); \
+            } \
+            /* flags passed from test_h_testdata */ \
+            if (test_h_context->flags & TEST_H_FILTERED) { \
+                /* not run */ \
+            } else if (test_h_context->flags & TEST_H_TODO) { \
+                test_h_context->global->todo += 1; \
             } else { \
-                test_h_context->global->passed += 1; \
+                test_h_context->global->total += 1; \
+                if (test_h_context->flags & TEST_H_FAILED) { \
+                    test_h_context->global->failed += 1; \
+                } else { \
+                    test_h_context->global->passed += 1; \
+                } \
             } \
+            test_h_release(test_h_context->global); \
         } \
         test_h_context->flags = TEST_H_NONE; \
     } while (0)
@@ -315,6 +1959,50 @@ test_h_filter_testcase(test_h_filter_t *filter,
 
 #define TEST_DATA(type) ((type)(test_h_context->userdata))
 
+/* usage and option arguments, also for a main of the caller (test3.c) */
+static TEST_H_MAYBE_UNUSED void
+test_h_help(FILE *stream)
+{
+    fprintf(stream, "%s%s%s%s%s", TEST_H_HELP, TEST_H_HELP_OPTIONS,
+            TEST_H_HELP_PROCESSES, TEST_H_HELP_REPORTS, TEST_H_HELP_BENCH);
+}
+
+/* a decimal number from <min> to <max> */
+static TEST_H_MAYBE_UNUSED int
+test_h_number(const char *opt, const char *arg, int min, int max)
+{
+    const char *p = arg;
+    long n = 0;
+
+    while (*p >= '0' && *p <= '9' && n <= max) {
+        n = n * 10 + (*p++ - '0');
+    }
+    if (*p != '\0' || p == arg || n < min || n > max) {
+        test_h_help(stderr);
+        fprintf(stderr, "\n[ERROR] invalid argument for %s: %s\n", opt, arg);
+        exit(EXIT_FAILURE);
+    }
+    return (int)n;
+}
+
+/* one of the names of TEST_H_FORMAT_* */
+static TEST_H_MAYBE_UNUSED int
+test_h_format(const char *opt, const char *arg)
+{
+    static const char *const names[] = {"text", "jsonl", "tap", "junit"};
+    int i;
+
+    for (i = 0; i < 4 && !test_h_str_eq(names[i], arg); i += 1) {
+        continue;
+    }
+    if (i == 4) {
+        test_h_help(stderr);
+        fprintf(stderr, "\n[ERROR] invalid argument for %s: %s\n", opt, arg);
+        exit(EXIT_FAILURE);
+    }
+    return i;
+}
+
 #ifndef TEST_MAIN
 #define TEST_MAIN \
     static void test_h_main(test_h_globaldata_t *test_h_globaldata) \
@@ -322,26 +2010,6 @@ test_h_filter_testcase(test_h_filter_t *filter,
 
 static void test_h_main(test_h_globaldata_t *test_h_globaldata);
 
-#include <sys/time.h>
-
-#ifndef timersub
-#define timersub(a, b, t) \
-    do { \
-        (t)->tv_sec = (a)->tv_sec - (b)->tv_sec; \
-        (t)->tv_usec = (a)->tv_usec - (b)->tv_usec; \
-        if ((t)->tv_usec < 0) { \
-            (t)->tv_sec--; \
-            (t)->tv_usec += 1000000; \
-        } \
-    } while (0)
-#endif /* timersub */
-
-static void
-test_h_help(FILE *stream)
-{
-    fprintf(stream, "%s", TEST_H_HELP);
-}
-
 static void
 test_h_need_argument(const char *opt, const char *arg)
 {
@@ -352,38 +2020,31 @@ test_h_need_argument(const char *opt, const char *arg)
     }
 }
 
-static test_h_filter_t *
-test_h_add_filter(test_h_filter_t *filter,
-                  const char *suite,
-                  const char *test)
+static void
+test_h_need_processes(const char *opt)
 {
-    if (suite != NULL || test != NULL) {
-        filter->next = (test_h_filter_t *)malloc(sizeof(test_h_filter_t));
-        filter = filter->next;
-        if (filter != NULL) {
-            filter->suite = suite;
-            filter->test = test;
-            filter->next = NULL;
-        } else {
-            fprintf(stderr, "\n[ERROR] failed to allocate memory\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    return filter;
+#ifndef TEST_H_JOBS
+    fprintf(stderr, "\n[ERROR] unsupported option: %s\n", opt);
+    exit(EXIT_FAILURE);
+#else
+    (void)opt;
+#endif
 }
 
 int main(int argc, const char **argv)
 {
     test_h_globaldata_t data;
     test_h_filter_t *filter;
-    int i, dashdash = 0;
+    int i, j, dashdash = 0;
     const char *suite = NULL;
-    struct timeval time_start, time_end, time_used;
+    test_h_stats_t time_used;
 
     memset(&data, 0, sizeof(data));
     filter = &data.filter;
+    data.bench_time = 300;
 
     for (i = 1; i < argc; i += 1) {
+        j = i;
         if (dashdash || argv[i][0] != '-' || argv[i][1] == '\0') {
             test_h_help(stderr);
             fprintf(stderr, "\n[ERROR] unexpected argument#%d: %s\n",
@@ -418,41 +2079,105 @@ int main(int argc, const char **argv)
             filter = test_h_add_filter(filter, suite, argv[i + 1]);
             i += 1;
             continue;
+        } else if (test_h_str_eq("-x", argv[i])
+                || test_h_str_eq("--exclude", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            test_h_add_exclude(filter, argv[i + 1]);
+            i += 1;
+        } else if (test_h_str_eq("-j", argv[i])
+                || test_h_str_eq("--jobs", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.jobs = test_h_number(argv[i], argv[i + 1], 1, 1024);
+            if (data.jobs > 1) {
+                test_h_need_processes(argv[i]);
+            }
+            i += 1;
+        } else if (test_h_str_eq("-i", argv[i])
+                || test_h_str_eq("--isolate", argv[i])) {
+            test_h_need_processes(argv[i]);
+            data.isolate = 1;
+        } else if (test_h_str_eq("-t", argv[i])
+                || test_h_str_eq("--timeout", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            test_h_need_processes(argv[i]);
+            data.timeout = test_h_number(argv[i], argv[i + 1], 0, 86400);
+            data.isolate = 1;
+            i += 1;
+        } else if (test_h_str_eq("--shard-index", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.shard = test_h_number(argv[i], argv[i + 1], 0, 65535);
+            i += 1;
+        } else if (test_h_str_eq("--shard-count", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.shards = test_h_number(argv[i], argv[i + 1], 1, 65536);
+            i += 1;
+        } else if (test_h_str_eq("-d", argv[i])
+                || test_h_str_eq("--durations", argv[i])) {
+            data.durations = 1;
+        } else if (test_h_str_eq("-S", argv[i])
+                || test_h_str_eq("--slowest", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.slowest = test_h_number(argv[i], argv[i + 1], 0, 1 << 30);
+            i += 1;
+        } else if (test_h_str_eq("-f", argv[i])
+                || test_h_str_eq("--format", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.format = test_h_format(argv[i], argv[i + 1]);
+            i += 1;
+        } else if (strncmp("--format=", argv[i], 9) == 0) {
+            data.format = test_h_format("--format", argv[i] + 9);
+        } else if (test_h_str_eq("-l", argv[i])
+                || test_h_str_eq("--list", argv[i])) {
+            data.list = 1;
+        } else if (test_h_str_eq("-b", argv[i])
+                || test_h_str_eq("--bench", argv[i])) {
+            data.bench = 1;
+        } else if (test_h_str_eq("--bench-time", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.bench_time = test_h_number(argv[i], argv[i + 1], 1, 3600000);
+            i += 1;
+        } else if (test_h_str_eq("--pin", argv[i])) {
+            test_h_need_argument(argv[i], argv[i + 1]);
+            data.pin = 1 + test_h_number(argv[i], argv[i + 1], 0, 1023);
+            i += 1;
+        } else if (test_h_str_eq("--fifo", argv[i])) {
+            data.fifo = 1;
         } else {
-            /* -o<value> and --option=<value> unsupported */
+            /* -o<value> and --option=<value> unsupported but --format */
             test_h_help(stderr);
             fprintf(stderr, "\n[ERROR] unknown option: %s\n", argv[i]);
             return EXIT_FAILURE;
         }
-        if (i > 1 && argv[i - 1] == suite) {
+        if (j > 1 && argv[j - 1] == suite) {
             filter = test_h_add_filter(filter, suite, NULL);
         }
         suite = NULL;
     }
 
-    if (!data.silent) {
-        printf("[INFO] Tests starting...\n");
-        if (gettimeofday(&time_start, NULL) != 0) {
-            TEST_H_ERROR_EXIT(gettimeofday);
-        }
+    if (data.shard > 0 && data.shard >= data.shards) {
+        test_h_help(stderr);
+        fprintf(stderr, "\n[ERROR] no shard #%d of %d\n",
+                data.shard, data.shards);
+        return EXIT_FAILURE;
     }
+    if (data.list) {
+#ifdef TEST_H_AUTO
+        test_h_list_all(&data);
+#else
+        /* walk the suites without running any test case */
+        test_h_main(&data);
+#endif
+        return EXIT_SUCCESS;
+    }
+    test_h_begin(&data);
+    test_h_usage(&time_used);
 
     test_h_main(&data);
+    test_h_join(&data);
 
-    if (!data.silent) {
-        if (gettimeofday(&time_end, NULL) != 0) {
-            TEST_H_ERROR_EXIT(gettimeofday);
-        }
-        timersub(&time_end, &time_start, &time_used);
-        printf("[INFO] Total / Passed / Failed: %d / %d / %d\n",
-                data.total,
-                data.passed,
-                data.failed);
-        printf("[INFO] Time used: %ld minutes %ld.%06ld seconds\n",
-                time_used.tv_sec / 60,
-                time_used.tv_sec % 60,
-                (time_t)time_used.tv_usec);
-    }
+    test_h_since(&time_used);
+    test_h_end(&data, time_used.wall);
+    test_h_report_slowest(&data);
 
     return data.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
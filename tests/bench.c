@@ -0,0 +1,965 @@
+/*\
+ / Benchmarks of argve on large command lines; run them with `make bench`.
+ /
+ / Every figure is the best of a few runs, in nanoseconds per argument.
+ / Branch misses are counted on Linux where perf events are permitted.
+\*/
+
+#ifdef __linux__
+#define _DEFAULT_SOURCE  /* syscall */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define ARGVE_H_WITH_IMPLEMENTATION
+#define ARGVE_H_WITH_BLOOM
+#define ARGVE_H_WITH_KINDS
+#define ARGVE_H_WITH_PRESCAN
+#define ARGVE_H_WITH_INDEX
+#define ARGVE_INDEX_MIN_SHORT 0  /* the index of any table to be measured */
+#define ARGVE_INDEX_MIN_LONG 0
+#define ARGVE_H_WITH_DFA
+#define ARGVE_H_WITH_RUN
+#define ARGVE_H_WITH_CHOICES
+#define ARGVE_H_WITH_PAIRS
+#define ARGVE_H_WITH_SUGGEST
+#define ARGVE_H_WITH_SNAPSHOT
+#define ARGVE_H_WITH_MANY
+#define ARGVE_H_API static
+#include <argve.h>
+
+#include "sfc.c"
+
+#define ERROR_EXIT(x) \
+    do { \
+        fflush(stdout); \
+        fprintf(stderr, "\n[ERROR] %s#L%d %s\n", __FILE__, __LINE__, #x); \
+        exit(EXIT_FAILURE); \
+    } while (0)
+
+#define MAX_ARGS 50000
+#define MAX_OPTS 4096
+#define MAX_JOBS 10000
+#define REPEATS 5
+
+static char *argv[MAX_ARGS];
+static argve_option options[MAX_OPTS + 1];
+static char arena[(MAX_ARGS + MAX_OPTS) * 32];
+static unsigned char bloom_bits[MAX_OPTS * 2];
+static unsigned char kinds[MAX_ARGS];
+static argve_name index_names[MAX_OPTS];
+static unsigned long index_shorts[ARGVE_INDEX_WORDS(MAX_OPTS)];
+static unsigned char snapshot_data[ARGVE_SNAPSHOT_SIZE(MAX_ARGS * 2)];
+static argve_job jobs[MAX_JOBS];
+static argve_result results[MAX_JOBS];
+static argve_token slabs[MAX_JOBS * 33];
+
+static double now_usec(void)
+{
+    struct timeval tv;
+
+    if (gettimeofday(&tv, NULL) != 0) {
+        ERROR_EXIT(gettimeofday);
+    }
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+#ifdef __linux__
+static int perf_fd = -1;
+
+static void perf_open(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* start counting branch misses */
+static void perf_start(void)
+{
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+/* return the number of branch misses since perf_start, or -1 */
+static double perf_stop(void)
+{
+    __u64 count;
+
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(perf_fd, &count, sizeof(count)) == sizeof(count)) {
+            return (double)count;
+        }
+    }
+    return -1;
+}
+#else
+static void perf_open(void) {}
+static void perf_start(void) {}
+static double perf_stop(void) { return -1; }
+#endif
+
+/* <n> options with long flags "option-<i>" and a few short flags */
+static char *setup_options(char *memory, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        options[i].need_arg = i % 2;
+        options[i].shortopt = i < 26 ? 'a' + i : 0;
+        options[i].longopt = memory;
+        memory += sprintf(memory, "option-%d", i) + 1;
+    }
+    options[n].need_arg = 0;
+    options[n].shortopt = 0;
+    options[n].longopt = NULL;
+    return memory;
+}
+
+/* <argc> arguments where <unknown> out of 100 are flags to pass through */
+static void setup_argv(char *memory, sfc64 *rng, int argc, int n, int unknown)
+{
+    int i;
+
+    for (i = 0; i < argc; i++) {
+        argv[i] = memory;
+        if ((int)sfc64_rand(rng, 100) < unknown) {
+            memory += sprintf(memory, "--forward-%d=%d", i % 977, i) + 1;
+        } else {
+            memory += sprintf(memory, "--option-%d=%d",
+                              (int)sfc64_rand(rng, n) | 1, i) + 1;
+        }
+    }
+}
+
+/* parse argv <rounds> times and return the best time per argument */
+static double parse(int argc, argve_bloom *bloom, int rounds)
+{
+    argve_state state;
+    double best = -1, start, used;
+    int i, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            state.bloom = bloom;
+            while (argve_next(&state) != ARGVE_END) {
+                /* nothing */
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    return best;
+}
+
+static void bench_bloom(sfc64 *rng)
+{
+    static const int counts[] = {16, 256, 4096};
+    static const int unknowns[] = {50, 90, 100};
+    argve_bloom bloom;
+    char *memory;
+    int i, j, n, argc;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        n = counts[i];
+        argc = n > 256 ? MAX_ARGS / 10 : MAX_ARGS;
+        memory = setup_options(arena, n);
+        if (!argve_bloom_init(&bloom, options, bloom_bits, n * 2)) {
+            ERROR_EXIT(argve_bloom_init);
+        }
+        for (j = 0; j < (int)(sizeof(unknowns) / sizeof(*unknowns)); j++) {
+            setup_argv(memory, rng, argc, n, unknowns[j]);
+            printf("[BENCH] bloom : %4d options, %3d%% unknown ..."
+                   " %9.1f ns/arg (linear %9.1f ns/arg)\n",
+                   n, unknowns[j],
+                   parse(argc, &bloom, 2), parse(argc, NULL, 2));
+            fflush(stdout);
+        }
+    }
+}
+
+/* parse argv of mostly file paths <rounds> times; see parse */
+static double parse_paths(int argc, int mode, int rounds)
+{
+    argve_state state;
+    double best = -1, start, used;
+    int i, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            if (mode > 0) {
+                argve_classify(argv, argc, kinds);
+                state.kinds = kinds;
+            }
+            do {
+                if (mode > 1) {
+                    argve_skip_text(&state);
+                }
+            } while (argve_next(&state) != ARGVE_END);
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    return best;
+}
+
+static void bench_kinds(sfc64 *rng)
+{
+    static const int flags[] = {0, 5, 50};
+    char *memory;
+    int i, j, argc = MAX_ARGS;
+
+    for (i = 0; i < (int)(sizeof(flags) / sizeof(*flags)); i++) {
+        memory = setup_options(arena, 16);
+        for (j = 0; j < argc; j++) {
+            argv[j] = memory;
+            if ((int)sfc64_rand(rng, 100) < flags[i]) {
+                memory += sprintf(memory, "-%c", 'a' + j % 26) + 1;
+            } else {
+                memory += sprintf(memory, "/data/%d/%x.dat", j % 7,
+                                  (unsigned)sfc64_rand(rng, 1 << 20)) + 1;
+            }
+        }
+        printf("[BENCH] kinds : %2d%% flags ... %6.1f ns/arg"
+               " (classified %6.1f ns/arg, skipping %6.1f ns/arg)\n",
+               flags[i], parse_paths(argc, 0, 10),
+               parse_paths(argc, 1, 10), parse_paths(argc, 2, 10));
+        fflush(stdout);
+    }
+}
+
+/* validate and replay a snapshot <rounds> times; see parse */
+static double replay(int argc, unsigned long size, int rounds)
+{
+    argve_state state;
+    argve_snapshot snapshot;
+    double best = -1, start, used;
+    int i, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)
+                    || !argve_snapshot_open(&snapshot, &state, argv,
+                                            snapshot_data, size)) {
+                ERROR_EXIT(argve_snapshot_open);
+            }
+            while (argve_snapshot_next(&snapshot, &state) != ARGVE_END) {
+                /* nothing */
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    return best;
+}
+
+/* parse argv <rounds> times with or without an index; see parse */
+static double parse_indexed(int argc, argve_index *index, int rounds)
+{
+    argve_state state;
+    double best = -1, start, used;
+    int i, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            state.index = index;
+            while (argve_next(&state) != ARGVE_END) {
+                /* nothing */
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    return best;
+}
+
+static void bench_index(sfc64 *rng)
+{
+    static const int counts[] = {16, 94, 256, 4096};
+    argve_index index;
+    char *memory;
+    int i, j, n, c, argc;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        n = counts[i];
+        argc = n > 256 ? MAX_ARGS / 10 : MAX_ARGS;
+        memory = setup_options(arena, n);
+        /* every visible character but '-' in reverse order of the table */
+        for (j = 0; j < n; j++) {
+            options[j].need_arg = 0;
+            c = 0x7E - j;
+            options[j].shortopt = j >= 94 ? 0 : c == '-' ? '!' : c;
+        }
+        if (!argve_index_init(&index, options, index_names, index_shorts,
+                              MAX_OPTS)) {
+            ERROR_EXIT(argve_index_init);
+        }
+        for (j = 0; j < argc; j++) {
+            argv[j] = memory;
+            memory += sprintf(memory, "-%c",
+                              0x7E - (int)sfc64_rand(rng, n < 94 ? n : 94)
+                              ) + 1;
+        }
+        printf("[BENCH] index : %4d options, short flags ..."
+               " %9.1f ns/arg (linear %9.1f ns/arg)\n",
+               n, parse_indexed(argc, &index, 2),
+               parse_indexed(argc, NULL, 2));
+        setup_argv(memory, rng, argc, n, 0);
+        printf("[BENCH] index : %4d options, long flags ...."
+               " %9.1f ns/arg (linear %9.1f ns/arg)\n",
+               n, parse_indexed(argc, &index, 2),
+               parse_indexed(argc, NULL, 2));
+        fflush(stdout);
+    }
+}
+
+/* parse argv with either engine; see parse, <misses> per argument */
+static double parse_engine(int argc, int dfa, int rounds, double *misses)
+{
+    argve_state state;
+    double best = -1, start, used, count;
+    int i, r;
+
+    *misses = -1;
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        perf_start();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            if (dfa) {
+                while (argve_next_dfa(&state) != ARGVE_END) {
+                    /* nothing */
+                }
+            } else {
+                while (argve_next(&state) != ARGVE_END) {
+                    /* nothing */
+                }
+            }
+        }
+        count = perf_stop();
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+            *misses = count < 0 ? -1 : count / ((double)argc * rounds);
+        }
+    }
+    return best;
+}
+
+static void bench_dfa(sfc64 *rng)
+{
+    static const char *const kinds[] = {"mixed", "clusters", "long"};
+    double t1, t2, m1, m2;
+    char *memory;
+    int i, j, k, argc = MAX_ARGS;
+
+    for (i = 0; i < (int)(sizeof(kinds) / sizeof(*kinds)); i++) {
+        memory = setup_options(arena, 64);
+        for (j = 0; j < argc; j++) {
+            argv[j] = memory;
+            k = i == 0 ? (int)sfc64_rand(rng, 5) : i == 1 ? 1 : 3;
+            if (k == 0) {
+                memory += sprintf(memory, "file-%d.txt", j) + 1;
+            } else if (k == 1) {
+                /* clusters of flags without values */
+                memory += sprintf(memory, "-%c%c%c", 'a' + j % 13 * 2,
+                                  'a' + j % 7 * 2, 'a' + j % 3 * 2) + 1;
+            } else if (k == 2) {
+                memory += sprintf(memory, "-b%d", j) + 1;
+            } else if (k == 3) {
+                memory += sprintf(memory, "--option-%d=%d",
+                                  (int)sfc64_rand(rng, 64), j) + 1;
+            } else {
+                memory += sprintf(memory, "--unknown-%d", j) + 1;
+            }
+        }
+        t1 = parse_engine(argc, 0, 4, &m1);
+        t2 = parse_engine(argc, 1, 4, &m2);
+        if (m1 < 0 || m2 < 0) {
+            printf("[BENCH] dfa : %-8s ... %6.1f ns/arg"
+                   " (branches %6.1f ns/arg), branch misses n/a\n",
+                   kinds[i], t2, t1);
+        } else {
+            printf("[BENCH] dfa : %-8s ... %6.1f ns/arg"
+                   " (branches %6.1f ns/arg), %.3f misses/arg (%.3f)\n",
+                   kinds[i], t2, t1, m2, m1);
+        }
+        fflush(stdout);
+    }
+}
+
+static unsigned long run_counts[26];
+
+static int run_count(void *context, char *value)
+{
+    (void)value;
+    *(unsigned long *)context += 1;
+    return 0;
+}
+
+static int run_count_a(void *context, char *value)
+{
+    (void)context; (void)value;
+    run_counts[0] += 1;
+    return 0;
+}
+
+static int run_count_b(void *context, char *value)
+{
+    (void)context;
+    run_counts[1] += value != NULL;
+    return 0;
+}
+
+/* dispatch with a switch in the loop of argve_next or with argve_run */
+static double dispatch(int argc, int push, int rounds)
+{
+    argve_handler handlers[MAX_OPTS];
+    argve_handlers run;
+    argve_state state;
+    double best = -1, start, used;
+    unsigned long texts = 0;
+    int i, r;
+
+    for (i = 0; i < MAX_OPTS; i++) {
+        handlers[i] = i == 0 ? run_count_a : i == 1 ? run_count_b : NULL;
+    }
+    run.options = handlers;
+    run.text = run_count;
+    run.error = NULL;
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            if (push) {
+                argve_run(&state, &run, &texts);
+                continue;
+            }
+            while (argve_next(&state) != ARGVE_END) {
+                if (state.type == ARGVE_TEXT) {
+                    texts += 1;
+                } else if (state.option == NULL) {
+                    break;
+                } else if (state.option->shortopt == 'a') {
+                    run_counts[0] += 1;
+                } else if (state.option->shortopt == 'b') {
+                    run_counts[1] += state.argstr != NULL;
+                }
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    if (texts == 0) {
+        ERROR_EXIT(dispatch);
+    }
+    return best;
+}
+
+static void bench_run(sfc64 *rng)
+{
+    char *memory;
+    int j, argc = MAX_ARGS;
+
+    memory = setup_options(arena, 26);
+    for (j = 0; j < argc; j++) {
+        argv[j] = memory;
+        switch (sfc64_rand(rng, 4)) {
+        case 0:
+            memory += sprintf(memory, "-%c", 'a' + j % 26) + 1;
+            break;
+        case 1:
+            memory += sprintf(memory, "-b%d", j) + 1;
+            break;
+        case 2:
+            memory += sprintf(memory, "-aca") + 1;
+            break;
+        default:
+            memory += sprintf(memory, "file-%d", j) + 1;
+            break;
+        }
+    }
+    printf("[BENCH] run : push dispatch ... %6.1f ns/arg"
+           " (pull %6.1f ns/arg)\n", dispatch(argc, 1, 10),
+           dispatch(argc, 0, 10));
+    fflush(stdout);
+}
+
+/* resolve values with a chain of strcmp or argve_choices; see parse */
+static double choose(int argc, const argve_choices *const *sets,
+                     const char *const *names, int rounds)
+{
+    argve_state state;
+    double best = -1, start, used;
+    unsigned long sum = 0;
+    int i, j, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            state.choices = sets;
+            while (argve_next(&state) != ARGVE_END) {
+                if (sets != NULL) {
+                    sum += state.choice;
+                    continue;
+                }
+                for (j = 0; names[j] != NULL; j++) {
+                    if (strcmp(names[j], state.argstr) == 0) {
+                        break;
+                    }
+                }
+                sum += j;
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    if (sum == 0) {
+        ERROR_EXIT(choose);
+    }
+    return best;
+}
+
+static void bench_choices(sfc64 *rng)
+{
+    static const int counts[] = {4, 32, 256};
+    static const char *names[256 + 1];
+    static int slots[512];
+    const argve_choices *sets[2];
+    argve_choices choices;
+    char *memory;
+    int i, j, n, argc = MAX_ARGS;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        n = counts[i];
+        memory = setup_options(arena, 1);
+        for (j = 0; j < n; j++) {
+            names[j] = memory;
+            memory += sprintf(memory, "value-%d", j) + 1;
+        }
+        names[n] = NULL;
+        if (!argve_choices_init(&choices, names, slots, n * 2)) {
+            ERROR_EXIT(argve_choices_init);
+        }
+        sets[0] = &choices;
+        sets[1] = NULL;
+        for (j = 0; j < argc; j++) {
+            argv[j] = memory;
+            memory += sprintf(memory, "--option-0=value-%d",
+                              (int)sfc64_rand(rng, n)) + 1;
+        }
+        options[0].need_arg = 1;
+        printf("[BENCH] choices : %3d choices ... %6.1f ns/arg"
+               " (strcmp %6.1f ns/arg)\n", n,
+               choose(argc, sets, names, 4), choose(argc, NULL, names, 4));
+        fflush(stdout);
+    }
+}
+
+/* split -Dkey=value by strchr and copying the key (mode 0), by argve_next
+ * (mode 1) and collecting the pairs unique by key as well (mode 2) */
+static double split(int argc, int mode, argve_pairs *pairs, int rounds)
+{
+    static const unsigned char flags[1] = {1};
+    argve_state state;
+    double best = -1, start, used;
+    unsigned long sum = 0;
+    char key[64], *p;
+    int i, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            if (mode > 0) {
+                state.pairs = flags;
+            }
+            if (mode > 1 && !argve_pairs_init(pairs, pairs->pairs,
+                                              pairs->slots, argc)) {
+                ERROR_EXIT(argve_pairs_init);
+            }
+            while (argve_next(&state) != ARGVE_END) {
+                if (mode > 1) {
+                    sum += argve_pairs_add(pairs, &state) + 1;
+                } else if (mode > 0) {
+                    sum += state.argstr[0] + (state.valstr[0] != '\0');
+                } else {
+                    p = strchr(state.argstr, '=');
+                    memcpy(key, state.argstr, p - state.argstr);
+                    key[p - state.argstr] = '\0';
+                    sum += key[0] + (p[1] != '\0');
+                }
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    if (sum == 0) {
+        ERROR_EXIT(split);
+    }
+    return best;
+}
+
+static void bench_pairs(sfc64 *rng)
+{
+    static const int counts[] = {16, 4096};
+    static argve_pair memory[MAX_ARGS];
+    static int slots[MAX_ARGS * 2];
+    argve_pairs pairs;
+    char *p;
+    int i, j, n, argc = MAX_ARGS;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        n = counts[i];
+        p = setup_options(arena, 1);
+        options[0].need_arg = 1;
+        options[0].shortopt = 'D';
+        for (j = 0; j < argc; j++) {
+            argv[j] = p;
+            p += sprintf(p, "-DSOME_MACRO_%d=%d",
+                         (int)sfc64_rand(rng, n), j) + 1;
+        }
+        if (!argve_pairs_init(&pairs, memory, slots, argc)) {
+            ERROR_EXIT(argve_pairs_init);
+        }
+        printf("[BENCH] pairs : %4d keys ... %6.1f ns/arg"
+               " (collected %6.1f, strchr %6.1f ns/arg)\n", n,
+               split(argc, 1, &pairs, 4), split(argc, 2, &pairs, 4),
+               split(argc, 0, &pairs, 4));
+        fflush(stdout);
+    }
+}
+
+/* the textbook dynamic programming, one row at a time */
+static int levenshtein(const char *a, const char *b)
+{
+    int row[64], i, j, diagonal, up;
+    int m = (int)strlen(a), n = (int)strlen(b);
+
+    for (j = 0; j <= n; j++) {
+        row[j] = j;
+    }
+    for (i = 1; i <= m; i++) {
+        diagonal = row[0];
+        row[0] = i;
+        for (j = 1; j <= n; j++) {
+            up = row[j];
+            row[j] = diagonal + (a[i - 1] != b[j - 1]);
+            if (row[j] > up + 1) row[j] = up + 1;
+            if (row[j] > row[j - 1] + 1) row[j] = row[j - 1] + 1;
+            diagonal = up;
+        }
+    }
+    return row[n];
+}
+
+/* the nearest long option to each of <count> typos, in usec per query */
+static double suggest(char **names, int count, int naive)
+{
+    argve_suggestion found;
+    argve_option *p;
+    double best = -1, start, used;
+    int i, r, d, sum = 0;
+
+    for (r = 0; r < REPEATS; r++) {
+        start = now_usec();
+        for (i = 0; i < count; i++) {
+            if (!naive) {
+                sum += argve_suggest(options, names[i], &found, 1);
+                continue;
+            }
+            found.option = NULL;
+            found.distance = (int)strlen(names[i]) / 3 + 2;
+            for (p = options; p->longopt != NULL; p++) {
+                if ((d = levenshtein(names[i], p->longopt)) < found.distance) {
+                    found.option = p;
+                    found.distance = d;
+                }
+            }
+            sum += found.option != NULL;
+        }
+        used = (now_usec() - start) / count;
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    if (sum == 0) {
+        ERROR_EXIT(suggest);
+    }
+    return best;
+}
+
+static void bench_suggest(sfc64 *rng)
+{
+    static const int counts[] = {64, 4096};
+    char *memory, *p;
+    int i, j, n, count = 200;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        memory = setup_options(arena, counts[i]);
+        for (j = 0; j < count; j++) {
+            /* "option-<i>" with two adjacent letters swapped */
+            argv[j] = memory;
+            n = sprintf(memory, "option-%d", (int)sfc64_rand(rng, counts[i]));
+            p = memory + sfc64_rand(rng, 5);
+            p[0] ^= p[1]; p[1] ^= p[0]; p[0] ^= p[1];
+            memory += n + 1;
+        }
+        printf("[BENCH] suggest : %4d options ... %8.2f us/query"
+               " (naive %8.2f us/query)\n", counts[i],
+               suggest(argv, count, 0), suggest(argv, count, 1));
+        fflush(stdout);
+    }
+}
+
+static void bench_snapshot(sfc64 *rng)
+{
+    static const int counts[] = {16, 256};
+    argve_state state;
+    unsigned long size;
+    char *memory;
+    int i, argc = MAX_ARGS;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        memory = setup_options(arena, counts[i]);
+        setup_argv(memory, rng, argc, counts[i], 50);
+        if (!argve_init(&state, options, argc, argv)
+                || !(size = argve_snapshot_save(&state, argv, snapshot_data,
+                                                sizeof(snapshot_data)))) {
+            ERROR_EXIT(argve_snapshot_save);
+        }
+        printf("[BENCH] snapshot : %4d options ... %6.1f ns/arg"
+               " (parsing %6.1f ns/arg)\n", counts[i],
+               replay(argc, size, 10), parse(argc, NULL, 2));
+        fflush(stdout);
+    }
+}
+
+/* find 3 options of the table by argve_prescan; see parse */
+static double prescan(int argc, argve_option *wanted, int rounds)
+{
+    double best = -1, start, used;
+    char *found[4];
+    int i, r, n = 0;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            n += argve_prescan(argc, argv, wanted, found);
+        }
+        used = (now_usec() - start) * 1e3 / ((double)argc * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    if (n <= 0) {
+        ERROR_EXIT(argve_prescan);
+    }
+    return best;
+}
+
+static void bench_prescan(sfc64 *rng)
+{
+    static const int counts[] = {16, 256};
+    argve_option wanted[4];
+    char *memory;
+    int i, argc = MAX_ARGS;
+
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        memory = setup_options(arena, counts[i]);
+        setup_argv(memory, rng, argc, counts[i], 10);
+        wanted[0] = options[1];
+        wanted[1] = options[3];
+        wanted[2] = options[counts[i] - 1];
+        wanted[3] = options[counts[i]];
+        printf("[BENCH] prescan : %4d options ... %6.1f ns/arg"
+               " (parsing %6.1f ns/arg)\n", counts[i],
+               prescan(argc, wanted, 10), parse(argc, NULL, 2));
+        fflush(stdout);
+    }
+}
+
+/* re-parse a line of <argc> arguments after an edit of the last one, fully
+ * or incrementally, and return the best time per edit in microseconds */
+static double reparse(int argc, int incremental, int rounds)
+{
+    static argve_token tokens[4096];
+    argve_state state;
+    double best = -1, start, used;
+    int i, r, count;
+
+    if (!argve_init(&state, options, argc, argv)) {
+        ERROR_EXIT(argve_init);
+    }
+    count = argve_tokenize(&state, argv, tokens, 4096);
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (!argve_init(&state, options, argc, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+            if (incremental) {
+                count = argve_retokenize(&state, argv, tokens, count, 4096,
+                                         argc - 1);
+            } else {
+                count = argve_tokenize(&state, argv, tokens, 4096);
+            }
+        }
+        used = (now_usec() - start) / rounds;
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    if (count != argc + 1) {
+        ERROR_EXIT(reparse);
+    }
+    return best;
+}
+
+static void bench_reparse(sfc64 *rng)
+{
+    static const int counts[] = {10, 100, 2000};
+    char *memory;
+    int i;
+
+    memory = setup_options(arena, 16);
+    setup_argv(memory, rng, 2000, 16, 0);
+    for (i = 0; i < (int)(sizeof(counts) / sizeof(*counts)); i++) {
+        printf("[BENCH] reparse : %4d arguments ... %8.2f us/edit"
+               " (full %8.2f us/edit)\n", counts[i],
+               reparse(counts[i], 1, 100), reparse(counts[i], 0, 100));
+        fflush(stdout);
+    }
+}
+
+/* tokenize all jobs <rounds> times and return the best time per job */
+static double parse_many(argve_index *index, int threads, int rounds)
+{
+    double best = -1, start, used;
+    int i, r;
+
+    for (i = 0; i < REPEATS; i++) {
+        start = now_usec();
+        for (r = 0; r < rounds; r++) {
+            if (argve_parse_many(jobs, MAX_JOBS, index, results, threads)
+                    != MAX_JOBS) {
+                ERROR_EXIT(argve_parse_many);
+            }
+        }
+        used = (now_usec() - start) * 1e3 / ((double)MAX_JOBS * rounds);
+        if (best < 0 || used < best) {
+            best = used;
+        }
+    }
+    return best;
+}
+
+static void bench_many(sfc64 *rng)
+{
+    argve_index index;
+    double serial = 0, used;
+    char *memory;
+    int i, threads, argc;
+
+    memory = setup_options(arena, 16);
+    setup_argv(memory, rng, MAX_ARGS, 16, 10);
+    if (!argve_index_init(&index, options, index_names, index_shorts,
+                          MAX_OPTS)) {
+        ERROR_EXIT(argve_index_init);
+    }
+    /* 8 to 32 arguments each, so that the jobs are uneven */
+    for (i = 0; i < MAX_JOBS; i++) {
+        argc = 8 + (int)sfc64_rand(rng, 25);
+        jobs[i].argv = argv + sfc64_rand(rng, MAX_ARGS - argc);
+        jobs[i].argc = argc;
+        results[i].tokens = slabs + 33 * i;
+        results[i].size = 33;
+    }
+    for (threads = 1; threads <= ARGVE_MANY_THREADS; threads *= 2) {
+        used = parse_many(&index, threads, 4);
+        if (threads == 1) {
+            serial = used;
+        }
+        printf("[BENCH] many : %2d threads ... %7.1f ns/job (%5.2fx)\n",
+               threads, used, serial / used);
+        fflush(stdout);
+    }
+}
+
+int main(void)
+{
+    sfc64 rng;
+
+    (void)argve_error; (void)argve_perror; (void)argve_tokenize;
+    sfc64_seed(&rng, 42);
+    perf_open();
+    bench_bloom(&rng);
+    bench_kinds(&rng);
+    bench_prescan(&rng);
+    bench_index(&rng);
+    bench_dfa(&rng);
+    bench_run(&rng);
+    bench_choices(&rng);
+    bench_pairs(&rng);
+    bench_suggest(&rng);
+    bench_snapshot(&rng);
+    bench_reparse(&rng);
+    bench_many(&rng);
+    return EXIT_SUCCESS;
+}
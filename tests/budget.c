@@ -0,0 +1,72 @@
+/*\
+ / A minimal program using argve for the size and startup budget.
+ /
+ / The hosted build takes the first argument "--start=<ns>" as the time
+ / just before exec(3) on CLOCK_MONOTONIC, and prints the nanoseconds used
+ / to get the first token.  The freestanding build only provides
+ / budget_parse for measuring code size.
+\*/
+
+#ifndef ARGVE_H_FREESTANDING
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#else
+#include <stddef.h>
+#endif
+
+#define ARGVE_H_WITH_IMPLEMENTATION
+#include <argve.h>
+
+static argve_option options[] = {
+    {0, 'h', "help"},
+    {0, 'v', "verbose"},
+    {1, 'o', "output"},
+    {1, 0, "start"},
+    {0, 0, NULL}
+};
+
+/* parse all arguments and return the number of errors */
+int budget_parse(int argc, char **argv)
+{
+    argve_state state;
+    int errors = 0;
+
+    if (!argve_init(&state, options, argc, argv)) {
+        return -1;
+    }
+    while (argve_next(&state) != ARGVE_END) {
+        errors += argve_error(&state);
+    }
+    return errors;
+}
+
+#ifndef ARGVE_H_FREESTANDING
+int main(int argc, char **argv)
+{
+    argve_state state;
+    struct timespec ts;
+    double start = -1, first;
+
+    if (!argve_init(&state, options, argc - 1, argv + 1)) {
+        return EXIT_FAILURE;
+    }
+    if (argve_next(&state) == ARGVE_LONG && state.option == &options[3]) {
+        start = atof(state.argstr);
+    }
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return EXIT_FAILURE;
+    }
+    first = ts.tv_sec * 1e9 + ts.tv_nsec;
+    while (argve_next(&state) != ARGVE_END) {
+        if (argve_error(&state)) {
+            argve_perror(&state, "[ERROR] ", stderr);
+        }
+    }
+    if (start >= 0) {
+        printf("%.0f\n", first - start);
+    }
+    return budget_parse(argc - 1, argv + 1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#endif /* !ARGVE_H_FREESTANDING */
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# Usage: budget.sh <budget file> <bin directory>
+#
+# Check the code size and startup latency of argve programs against budget.
+
+set -euf; unset -v IFS; export LC_ALL=C
+
+BUDGET="${1-"./tests/budget.txt"}"
+BIN="${2-"./tests/bin"}"
+
+echo() {
+  printf '%s\n' "$*"
+}
+# <object> <symbol>
+size() {
+  nm -S -t d "$1" | awk -v name="$2" '
+    NF == 4 && name == "total" && $4 ~ /^argve_/ { sum += $2 }
+    NF == 4 && $3 == "T" && $4 == name { sum += $2 }
+    END { print sum + 0 }
+  '
+}
+# <program>
+latency() {
+  "${BIN}/launch" "$1" 101 -v --output=out -o out file -- file \
+    | awk '{ printf "%d\n", $1 / 1000 }'
+}
+
+failed=0
+while read -r kind file name limit; do
+  case "${kind}" in
+    size)
+      used="$(size "${BIN}/${file}" "${name}")"
+      unit=bytes
+      ;;
+    latency)
+      used="$(latency "${BIN}/${file}")"
+      unit=usec
+      ;;
+    *)
+      continue
+      ;;
+  esac
+  if [ "${used}" -le "${limit}" ]; then
+    result=OK
+  else
+    result=FAILED
+    failed=$((failed + 1))
+  fi
+  echo "[BUDGET] ${kind} ${file} ${name} : ${used} / ${limit} ${unit} ... ${result}"
+done <"${BUDGET}"
+
+[ "${failed}" -eq 0 ]
@@ -0,0 +1,98 @@
+/*\
+ / Usage: launch <program> <runs> [<arguments>]...
+ /
+ / Run <program> --start=<ns> [<arguments>]... for <runs> times and print
+ / the median of nanoseconds it reports, i.e. from exec(3) to first token.
+\*/
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define ERROR_EXIT(x) \
+    do { \
+        fflush(stdout); \
+        fprintf(stderr, "\n[ERROR] %s#L%d %s\n", __FILE__, __LINE__, #x); \
+        exit(EXIT_FAILURE); \
+    } while (0)
+
+#define MAX_RUNS 1000
+
+static int compare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* run the program once and return the reported nanoseconds */
+static double launch(int argc, char **argv)
+{
+    char start[64], output[64], **args;
+    struct timespec ts;
+    int fds[2], status, i;
+    ssize_t n;
+    pid_t pid;
+
+    if ((args = (char **)malloc(sizeof(char *) * (argc + 2))) == NULL) {
+        ERROR_EXIT(malloc);
+    }
+    if (pipe(fds) != 0) {
+        ERROR_EXIT(pipe);
+    }
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        ERROR_EXIT(clock_gettime);
+    }
+    sprintf(start, "--start=%.0f", ts.tv_sec * 1e9 + ts.tv_nsec);
+    args[0] = argv[0];
+    args[1] = start;
+    for (i = 1; i < argc; i++) args[i + 1] = argv[i];
+    args[argc + 1] = NULL;
+
+    if ((pid = fork()) < 0) {
+        ERROR_EXIT(fork);
+    } else if (pid == 0) {
+        close(fds[0]);
+        if (dup2(fds[1], STDOUT_FILENO) < 0) {
+            _exit(127);
+        }
+        execv(args[0], args);
+        _exit(127);
+    }
+    close(fds[1]);
+    memset(output, 0, sizeof(output));
+    for (i = 0; i < (int)sizeof(output) - 1; i += n) {
+        if ((n = read(fds[0], output + i, sizeof(output) - 1 - i)) <= 0) {
+            break;
+        }
+    }
+    close(fds[0]);
+    free(args);
+    if (waitpid(pid, &status, 0) != pid
+            || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        ERROR_EXIT(waitpid);
+    }
+    return atof(output);
+}
+
+int main(int argc, char **argv)
+{
+    static double used[MAX_RUNS];
+    int i, runs;
+
+    if (argc < 3 || (runs = atoi(argv[2])) <= 0 || runs > MAX_RUNS) {
+        fprintf(stderr, "Usage: launch <program> <runs> [<arguments>]...\n");
+        return EXIT_FAILURE;
+    }
+    argv[2] = argv[1];
+    for (i = 0; i < runs; i++) {
+        used[i] = launch(argc - 2, argv + 2);
+    }
+    qsort(used, runs, sizeof(*used), compare);
+    printf("%.0f\n", used[runs / 2]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,402 @@
+/*\
+ / Differential testing of every engine of argve against the frozen
+ / reference engine in reference.c; run it with `make oracle`.
+ /
+ / Usage: oracle [<tokens>]
+ /
+ / Random tables of options and command lines full of edge cases are drawn
+ / from sfc64 (seeded by $SEED or the time), and each engine must end up in
+ / the very same state as the reference after every token, field by field.
+ / The first divergence is dumped with the seed and the command line.
+\*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <inttypes.h>
+
+#define ARGVE_H_WITH_IMPLEMENTATION
+#define ARGVE_H_WITH_ADAPTIVE
+#define ARGVE_H_WITH_BLOOM
+#define ARGVE_H_WITH_KINDS
+#define ARGVE_H_WITH_INDEX
+#define ARGVE_INDEX_MIN_SHORT 0  /* the index of any table to be tested */
+#define ARGVE_INDEX_MIN_LONG 0
+#define ARGVE_H_WITH_DFA
+#define ARGVE_H_WITH_HOOKS
+#define ARGVE_H_WITH_SNAPSHOT
+#define ARGVE_H_API static
+#include <argve.h>
+
+#include "reference.c"
+#include "sfc.c"
+#include "spec.c"  /* generated from tests/spec.txt */
+
+#define ERROR_EXIT(x) \
+    do { \
+        fflush(stdout); \
+        fprintf(stderr, "\n[ERROR] %s#L%d %s\n", __FILE__, __LINE__, #x); \
+        exit(EXIT_FAILURE); \
+    } while (0)
+
+#define MAX_ARGS 64
+#define MAX_OPTS 48
+#define MAX_SIZE 24
+
+enum {
+    ENGINE_NEXT, ENGINE_DFA, ENGINE_ADAPTIVE, ENGINE_BLOOM, ENGINE_KINDS,
+    ENGINE_INDEX, ENGINE_HOOKS, ENGINE_TOKENS, ENGINE_SNAPSHOT, ENGINES
+};
+
+static const char *const engine_names[ENGINES] = {
+    "argve_next", "argve_next_dfa", "adaptive", "bloom", "kinds",
+    "index", "hooks", "tokens", "snapshot"
+};
+
+static const char *const type_names[] = {
+    "ARGVE_END", "ARGVE_TEXT", "ARGVE_SHORT", "ARGVE_LONG", "ARGVE_CLUSTER",
+    "ARGVE_ERR_DEF_SHORT", "ARGVE_ERR_DEF_LONG", "ARGVE_ERR_ARG_SHORT",
+    "ARGVE_ERR_ARG_LONG", "ARGVE_ERR_UNKNOWN", "ARGVE_ERR_CHOICE"
+};
+
+/* flags and names made of the characters that matter to the parsers */
+static const char shorts[] = "abcx=-?\\~";
+static const char letters[] = "ab-x";
+static const char *const specials[] = {
+    "", "-", "--", "---", "-=", "--=", "--=x", "-a-", "--a=", "\x7F", "-\x80"
+};
+
+static char *argv[MAX_ARGS];
+static argve_option options[MAX_OPTS + 1];
+static char arena[(MAX_ARGS + MAX_OPTS) * MAX_SIZE];
+static argve_slot slots[MAX_OPTS + 1];
+static unsigned char bloom_bits[MAX_OPTS];
+static unsigned char kinds[MAX_ARGS];
+static argve_name index_names[MAX_OPTS + 1];
+static unsigned long index_shorts[ARGVE_INDEX_WORDS(MAX_OPTS + 1)];
+static unsigned char snapshot_data[ARGVE_SNAPSHOT_SIZE(MAX_ARGS * MAX_SIZE)];
+
+static void random_name(sfc64 *rng, char *s, int n)
+{
+    while (n-- > 0) {
+        *s++ = letters[sfc64_rand(rng, sizeof(letters) - 1)];
+    }
+    *s = '\0';
+}
+
+static int setup_options(sfc64 *rng, char *memory)
+{
+    int i, n = 1 + sfc64_rand(rng, MAX_OPTS);
+
+    for (i = 0; i < n; i++) {
+        options[i].need_arg = sfc64_rand(rng, 2);
+        switch (sfc64_rand(rng, 8)) {
+        case 0:
+            /* a virtual code */
+            options[i].shortopt = 300;
+            break;
+        case 1:
+            options[i].shortopt = 0;
+            break;
+        default:
+            options[i].shortopt = shorts[sfc64_rand(rng, sizeof(shorts) - 1)];
+        }
+        if (sfc64_rand(rng, 4) == 0) {
+            options[i].longopt = NULL;
+            if (options[i].shortopt == 0) {
+                options[i].shortopt = 'z';
+            }
+        } else {
+            options[i].longopt = memory;
+            random_name(rng, memory, 1 + sfc64_rand(rng, 4));
+            memory += MAX_SIZE;
+        }
+    }
+    options[n].need_arg = 0;
+    options[n].shortopt = 0;
+    options[n].longopt = NULL;
+    return n;
+}
+
+static int setup_argv(sfc64 *rng, char *memory, const argve_option *opts,
+                      int n)
+{
+    int i, j, argc = sfc64_rand(rng, MAX_ARGS + 1);
+    const char *name;
+    char *s;
+
+    for (i = 0; i < argc; i++) {
+        argv[i] = s = memory;
+        memory += MAX_SIZE;
+        switch (sfc64_rand(rng, 6)) {
+        case 0:
+            strcpy(s, specials[sfc64_rand(rng, sizeof(specials)
+                                                / sizeof(specials[0]))]);
+            break;
+        case 1:
+            random_name(rng, s, sfc64_rand(rng, 4));
+            break;
+        case 2: case 3:
+            /* -abc, -o<value> */
+            *s++ = '-';
+            for (j = sfc64_rand(rng, 4); j >= 0; j--) {
+                *s++ = shorts[sfc64_rand(rng, sizeof(shorts) - 1)];
+            }
+            *s = '\0';
+            break;
+        default:
+            /* --name, --name=, --name=value, --nam, --namex */
+            name = opts[sfc64_rand(rng, n)].longopt;
+            if (name == NULL || strlen(name) > MAX_SIZE / 2) {
+                name = "a";
+            }
+            sprintf(s, "--%s", name);
+            if ((j = sfc64_rand(rng, 8)) == 0) {
+                s[strlen(s) - 1] = '\0';
+            } else if (j == 1) {
+                strcat(s, "x");
+            } else if (j < 4) {
+                strcat(s, j == 2 ? "=" : "=a=b");
+            }
+        }
+    }
+    return argc;
+}
+
+static void print_string(const char *s)
+{
+    fputc('"', stderr);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(stderr, "\\%c", *s);
+        } else if ((unsigned char)*s < 0x20 || (unsigned char)*s >= 0x7F) {
+            fprintf(stderr, "\\x%02X", (unsigned char)*s);
+        } else {
+            fputc(*s, stderr);
+        }
+    }
+    fputc('"', stderr);
+}
+
+static void print_offset(const char *name, const char *p, char **args,
+                         int argc)
+{
+    int i;
+
+    fprintf(stderr, "    %s = ", name);
+    if (p == NULL) {
+        fprintf(stderr, "NULL\n");
+        return;
+    }
+    for (i = 0; i < argc; i++) {
+        if (args[i] <= p && p <= args[i] + strlen(args[i])) {
+            fprintf(stderr, "argv[%d] + %d\n", i, (int)(p - args[i]));
+            return;
+        }
+    }
+    fprintf(stderr, "%p (out of argv)\n", (void *)p);
+}
+
+static void print_state(const char *label, const argve_state *state,
+                        char **args, int argc)
+{
+    fprintf(stderr, "  %s:\n", label);
+    fprintf(stderr, "    options = %p\n", (void *)state->options);
+    if (state->option != NULL) {
+        fprintf(stderr, "    option = options[%d]\n",
+                (int)(state->option - state->options));
+    } else {
+        fprintf(stderr, "    option = NULL\n");
+    }
+    print_offset("optstr", state->optstr, args, argc);
+    print_offset("argstr", state->argstr, args, argc);
+    fprintf(stderr, "    argv = argv + %d\n", (int)(state->argv - args));
+    fprintf(stderr, "    argc = %d\n", state->argc);
+    if ((int)state->type >= 0 && (int)state->type
+            < (int)(sizeof(type_names) / sizeof(type_names[0]))) {
+        fprintf(stderr, "    type = %s\n", type_names[state->type]);
+    } else {
+        fprintf(stderr, "    type = %d\n", (int)state->type);
+    }
+}
+
+static int same_state(const argve_state *a, const argve_state *b)
+{
+    return a->options == b->options
+        && a->option == b->option
+        && a->optstr == b->optstr
+        && a->argstr == b->argstr
+        && a->argv == b->argv
+        && a->argc == b->argc
+        && a->type == b->type;
+}
+
+static void diverge(uint64_t seed, unsigned long round, int engine,
+                    const argve_state *reference, const argve_state *state,
+                    const argve_option *opts, int argc)
+{
+    int i;
+
+    fflush(stdout);
+    fprintf(stderr, "\n[ORACLE] %s diverged from the reference\n",
+            engine_names[engine]);
+    fprintf(stderr, "  SEED = %" PRIu64 ", round = %lu\n", seed, round);
+    fprintf(stderr, "  options:\n");
+    for (i = 0; !argve_option_end(opts + i); i++) {
+        fprintf(stderr, "    [%d] need_arg = %d, shortopt = %d, longopt = ",
+                i, opts[i].need_arg, opts[i].shortopt);
+        if (opts[i].longopt != NULL) {
+            print_string(opts[i].longopt);
+            fputc('\n', stderr);
+        } else {
+            fprintf(stderr, "NULL\n");
+        }
+    }
+    fprintf(stderr, "  argv:\n");
+    for (i = 0; i < argc; i++) {
+        fprintf(stderr, "    [%d] ", i);
+        print_string(argv[i]);
+        fputc('\n', stderr);
+    }
+    print_state("reference", reference, argv, argc);
+    print_state(engine_names[engine], state, argv, argc);
+    exit(EXIT_FAILURE);
+}
+
+static uint64_t get_seed(void)
+{
+    uint64_t seed = 0, n; char *s; struct timeval tv;
+
+    if ((s = getenv("SEED")) != NULL && *s != '\0') {
+        while ('0' <= *s && *s <= '9') {
+            seed = (seed * 10) + (*s++ - '0');
+        }
+        if (*s != '\0') {
+            ERROR_EXIT(SEED);
+        }
+    } else {
+        if (gettimeofday(&tv, NULL) != 0) {
+            ERROR_EXIT(gettimeofday);
+        }
+        n = sizeof(time_t) - sizeof(suseconds_t);
+        seed = tv.tv_sec ^ ((time_t)tv.tv_usec << n * 8);
+    }
+    return seed;
+}
+
+int main(int argc, char **args)
+{
+    unsigned long limit = 1000000, tokens = 0, round = 0;
+    unsigned long counts[ENGINES];
+    uint64_t seed = get_seed();
+    argve_state reference, states[ENGINES];
+    argve_adaptive adaptive;
+    argve_index index;
+    argve_bloom bloom;
+    argve_snapshot snapshot;
+    argve_token token;
+    argve_option *opts;
+    argve_type type;
+    sfc64 rng;
+    int i, n, count, hooked;
+    char *s;
+
+    (void)argve_error; (void)argve_perror; (void)argve_tokenize;
+    (void)argve_skip_text; (void)argve_retokenize;
+    if (argc > 2) {
+        ERROR_EXIT(usage: oracle [<tokens>]);
+    } else if (argc == 2) {
+        limit = strtoul(args[1], &s, 10);
+        if (*args[1] == '\0' || *s != '\0') {
+            ERROR_EXIT(<tokens>);
+        }
+    }
+    fprintf(stdout, "[INFO] SEED = %" PRIu64 "\n", seed);
+    memset(counts, 0, sizeof(counts));
+    sfc64_seed(&rng, seed);
+
+    while (tokens < limit) {
+        round += 1;
+        /* the generated matchers only know the options of the spec */
+        if ((hooked = (sfc64_rand(&rng, 8) == 0))) {
+            opts = spec_options;
+            n = SPEC_COUNT;
+        } else {
+            opts = options;
+            n = setup_options(&rng, arena + MAX_ARGS * MAX_SIZE);
+        }
+        count = setup_argv(&rng, arena, opts, n);
+        memset(&reference, 0, sizeof(reference));
+        if (!reference_init(&reference, opts, count, argv)) {
+            ERROR_EXIT(reference_init);
+        }
+        for (i = 0; i < ENGINES; i++) {
+            if (!argve_init(&states[i], opts, count, argv)) {
+                ERROR_EXIT(argve_init);
+            }
+        }
+        if (!argve_adaptive_init(&adaptive, opts, slots, n,
+                                 1 + sfc64_rand(&rng, 16))
+                || !argve_bloom_init(&bloom, opts, bloom_bits,
+                                     1 + sfc64_rand(&rng, MAX_OPTS))
+                || !argve_index_init(&index, opts, index_names,
+                                     index_shorts, n)) {
+            ERROR_EXIT(accelerators);
+        }
+        argve_classify(argv, count, kinds);
+        states[ENGINE_ADAPTIVE].adaptive = &adaptive;
+        states[ENGINE_BLOOM].bloom = &bloom;
+        states[ENGINE_KINDS].kinds = kinds;
+        states[ENGINE_INDEX].index = &index;
+        if (hooked) {
+            states[ENGINE_HOOKS].match_short = spec_match_short;
+            states[ENGINE_HOOKS].match_long = spec_match_long;
+        }
+        if (!argve_snapshot_save(&states[ENGINE_SNAPSHOT], argv,
+                                 snapshot_data, sizeof(snapshot_data))
+                || !argve_init(&states[ENGINE_SNAPSHOT], opts, count, argv)
+                || !argve_snapshot_open(&snapshot, &states[ENGINE_SNAPSHOT],
+                                        argv, snapshot_data,
+                                        sizeof(snapshot_data))) {
+            ERROR_EXIT(snapshot);
+        }
+        do {
+            type = reference_next(&reference);
+            tokens += 1;
+            for (i = 0; i < ENGINES; i++) {
+                switch (i) {
+                case ENGINE_DFA:
+                    argve_next_dfa(&states[i]);
+                    break;
+                case ENGINE_HOOKS:
+                    if (!hooked) {
+                        continue;
+                    }
+                    argve_next(&states[i]);
+                    break;
+                case ENGINE_TOKENS:
+                    argve_to_token(&reference, argv, &token);
+                    argve_from_token(&states[i], argv, &token);
+                    break;
+                case ENGINE_SNAPSHOT:
+                    argve_snapshot_next(&snapshot, &states[i]);
+                    break;
+                default:
+                    argve_next(&states[i]);
+                }
+                if (!same_state(&reference, &states[i])) {
+                    diverge(seed, round, i, &reference, &states[i],
+                            opts, count);
+                }
+                counts[i] += 1;
+            }
+        } while (type != ARGVE_END);
+    }
+    for (i = 0; i < ENGINES; i++) {
+        fprintf(stdout, "[ORACLE] %-16s %lu tokens OK\n",
+                engine_names[i], counts[i]);
+    }
+    fprintf(stdout, "[ORACLE] %lu rounds, %lu tokens\n", round, tokens);
+    return EXIT_SUCCESS;
+}
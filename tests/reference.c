@@ -0,0 +1,237 @@
+/*\
+ / The frozen reference engine of argve_next; see oracle.c.
+ /
+ / This is a verbatim copy of argve_init and argve_next of the first release
+ / with the prefix reference_ instead of argve_.  It defines the semantics
+ / that every engine in argve.h must reproduce byte for byte, so DO NOT touch
+ / it for performance or features.  Include it after argve.h.
+\*/
+
+static
+void reference_advance(argve_state *state)
+{
+    state->argc -= 1;
+    state->argv += 1;
+}
+
+static
+int reference_option_end(const argve_option *opts)
+{
+    return opts->shortopt == 0 && opts->longopt == NULL;
+}
+
+static
+int reference_to_short_opt(char c)
+{
+    return (c != '-' && c > 0x20 && c < 0x7F) ? (unsigned char)c : 0;
+}
+
+static
+argve_option * reference_match_short(const argve_option *opts, int c)
+{
+    if (opts == NULL || c == 0) {
+        return NULL;
+    }
+    while (!reference_option_end(opts)) {
+        if (opts->shortopt == c) {
+            return (argve_option *)opts;
+        }
+        opts += 1;
+    }
+    return NULL;
+}
+
+static
+char * reference_to_long_opt(const char *s, int search)
+{
+    char c; const char *p;
+
+    if (s != NULL && *s != '\0') {
+        if (search) {
+            /* --<name>[=<value>] */
+            if (s[0] != '-' || s[1] != '-' || s[2] == '\0' || s[2] == '=') {
+                return NULL;
+            }
+            s += 2;
+        }
+        p = s;
+        c = *p;
+        while (c != '=' && c > 0x20 && c < 0x7F) {
+            c = *(p += 1);
+        }
+        if (search) {
+            return (c == '\0' || c == '=') ? (char *)s : NULL;
+        }
+        return c == '\0' ? (char *)s : NULL;
+    }
+    return NULL;
+}
+
+static
+argve_option * reference_match_long(const argve_option *opts, const char *s)
+{
+    const char *p, *q;
+
+    if (opts == NULL || (s = reference_to_long_opt(s, 1)) == NULL) {
+        return NULL;
+    }
+    while (!reference_option_end(opts)) {
+        if ((p = opts->longopt) != NULL && *p) {
+            q = s;
+            while (*p && *q && *p == *q) {
+                p += 1; q += 1;
+            }
+            if (*p == '\0' && (*q == '\0' || *q == '=')) {
+                return (argve_option *)opts;
+            }
+        }
+        opts += 1;
+    }
+    return NULL;
+}
+
+static
+argve_type reference_next(argve_state *state)
+{
+    int c; char *arg;
+
+    /* parse cluster of short flags */
+    if (state->type == ARGVE_CLUSTER
+            && state->argstr == NULL && state->optstr[1] != '\0') {
+        /* process the next flag; -abc => -bc */
+        state->optstr += 1;
+        state->argstr = NULL;
+        c = reference_to_short_opt(state->optstr[0]);
+        state->option = reference_match_short(state->options, c);
+        if (state->option != NULL) {
+            /*state->type = ARGVE_CLUSTER;*/
+            if (state->option->need_arg) {
+                if (state->optstr[1] != '\0') {
+                    /* -o<value> */
+                    state->argstr = state->optstr + 1;
+                } else if (state->argc > 0) {
+                    /* -o <value> */
+                    state->argstr = state->argv[0];
+                    reference_advance(state);
+                } else {
+                    state->type = ARGVE_ERR_ARG_SHORT;
+                }
+            }
+        } else {
+            state->type = ARGVE_ERR_DEF_SHORT;
+        }
+        return state->type;
+    }
+
+    /* parse new argument */
+    if (state->argc > 0) {
+        state->type = ARGVE_ERR_UNKNOWN;
+        state->option = NULL;
+        state->optstr = NULL;
+        state->argstr = NULL;
+        arg = state->argv[0];
+        if (arg[0] == '-' && arg[1] != '-' && arg[1] != '\0') {
+            /* short flags; visible ASCII chars only; -a -b -ab<value> */
+            c = reference_to_short_opt(arg[1]);
+            state->option = reference_match_short(state->options, c);
+            if (state->option != NULL) {
+                state->type = ARGVE_SHORT;
+                state->optstr = arg + 1;
+                reference_advance(state);
+                if (state->option->need_arg) {
+                    if (state->optstr[1] != '\0') {
+                        /* -o<value> */
+                        state->argstr = state->optstr + 1;
+                    } else if (state->argc > 0) {
+                        /* -o <value> */
+                        state->argstr = state->argv[0];
+                        reference_advance(state);
+                    } else {
+                        state->type = ARGVE_ERR_ARG_SHORT;
+                    }
+                } else if (state->optstr[1] != '\0') {
+                    state->type = ARGVE_CLUSTER;
+                }
+            } else {
+                state->type = ARGVE_ERR_DEF_SHORT;
+                state->optstr = arg + 1;
+                reference_advance(state);
+            }
+        } else if (arg[0] == '-' && arg[1] == '-' && arg[2] != '\0') {
+            /* long flags; visible ASCII chars only; --name --name=<value> */
+            state->option = reference_match_long(state->options, arg);
+            arg += 2;
+            if (state->option != NULL) {
+                state->type = ARGVE_LONG;
+                state->optstr = arg;
+                reference_advance(state);
+                while (*arg && *arg != '=') {
+                    arg += 1;
+                }
+                if (state->option->need_arg) {
+                    if (*arg) {
+                        /* --name=<value> */
+                        state->argstr = arg + 1;
+                    } else if (state->argc > 0) {
+                        /* --name <value> */
+                        state->argstr = state->argv[0];
+                        reference_advance(state);
+                    } else {
+                        state->type = ARGVE_ERR_ARG_LONG;
+                    }
+                } else if (*arg) {
+                    state->type = ARGVE_ERR_ARG_LONG;
+                    state->argstr = arg + 1;
+                }
+            } else {
+                state->type = ARGVE_ERR_DEF_LONG;
+                state->optstr = arg;
+                reference_advance(state);
+            }
+        } else {
+            /* positional arguments including "--" and "-" */
+            state->type = ARGVE_TEXT;
+            state->argstr = arg;
+            reference_advance(state);
+        }
+    } else {
+        state->type = ARGVE_END;
+        state->option = NULL;
+        state->optstr = NULL;
+        state->argstr = NULL;
+    }
+    return state->type;
+}
+
+static
+int reference_init(argve_state *state, argve_option *opts,
+                   int argc, char **argv)
+{
+    argve_option *p = opts;
+    int i;
+
+    if (state == NULL || opts == NULL || argc < 0 || argv == NULL) {
+        return 0;
+    }
+    while (!reference_option_end(p)) {
+        /* names of long flags must contain only visible ASCII chars */
+        if (p->longopt != NULL && reference_to_long_opt(p->longopt, 0) == NULL) {
+            return 0;
+        }
+        p += 1;
+    }
+    /* argv needs not be NULL-terminated, but must not contain any NULL */
+    for (i = 0; i < argc; i += 1) {
+        if (argv[i] == NULL) {
+            return 0;
+        }
+    }
+    state->options = opts;
+    state->option = NULL;
+    state->optstr = NULL;
+    state->argstr = NULL;
+    state->argv = argv;
+    state->argc = argc;
+    state->type = ARGVE_ERR_UNKNOWN;
+    return 1;
+}
@@ -0,0 +1,58 @@
+#!/bin/sh
+
+# Usage: shard.sh <count> <program> [options]
+#
+# Run a test program as <count> processes at once, one shard of test cases
+# each (see --shard-count), then print their logs in the order of shards
+# and the counters merged into one line like an unsharded run (so no -q).
+
+set -euf; unset -v IFS; export LC_ALL=C
+
+COUNT="${1-"8"}"
+BIN="${2-"./tests/bin/test2"}"
+if [ $# -ge 2 ]; then shift 2; else shift $#; fi
+
+DIR="$(mktemp -d)"
+trap 'rm -rf "${DIR}"' EXIT
+
+pids=''
+i=0
+while [ "${i}" -lt "${COUNT}" ]; do
+  "${BIN}" ${1+"$@"} --shard-index "${i}" --shard-count "${COUNT}" \
+    >"${DIR}/${i}" 2>&1 &
+  pids="${pids} $!"
+  i=$((i + 1))
+done
+
+status=0
+for pid in ${pids}; do
+  if ! wait "${pid}"; then
+    status=1
+  fi
+done
+
+i=0
+while [ "${i}" -lt "${COUNT}" ]; do
+  sed -e '/^\[INFO\] Tests starting/ d' \
+      -e '/^\[INFO\] Total \/ Passed \/ Failed: / d' \
+      -e '/^\[INFO\] Time used/ d' "${DIR}/${i}"
+  i=$((i + 1))
+done
+i=0
+while [ "${i}" -lt "${COUNT}" ]; do
+  cat "${DIR}/${i}"
+  i=$((i + 1))
+done | awk -v count="${COUNT}" '
+  /^\[INFO\] Total \/ Passed \/ Failed: / {
+    total += $7; passed += $9; failed += $11; shards += 1
+  }
+  END {
+    printf "[INFO] Total / Passed / Failed: %d / %d / %d\n",
+           total, passed, failed
+    if (shards != count) {
+      printf "[ERROR] no counters from %d of %d shards\n",
+             count - shards, count
+    }
+  }
+'
+exit "${status}"
@@ -32,6 +32,78 @@ expected='
 [INFO] Total / Passed / Failed: 6 / 5 / 1
 '
 [ "${expected%?}" = "$(test)" ]
+[ "${expected%?}" = "$(test -j 2)" ]
+[ "${expected%?}" = "$(test -j 9)" ]
+[ "${expected%?}" = "$(test -i)" ]
+[ "${expected%?}" = "$(test -j 3 -t 60)" ]
+[ "${expected%?}" = "$(test -d | sed -e 's/ ([0-9]*\.[0-9]* ms)$//')" ]
+[ "${expected%?}" = "$(test -S 0)" ]
+[ "${expected%?}" = "$(test --bench --bench-time 1 --fifo)" ]
+[ 3 = "$(test -q -S 3 | grep -c '^\[SLOW\] .* ms, cpu .* ms, ')" ]
+[ 6 = "$(test -q -j 2 -S 9 | grep -c '^\[SLOW\] .* ms, cpu .* ms, ')" ]
+
+records() {
+  test ${1+"$@"} \
+    | sed -e 's/"duration_ms":[0-9]*\.[0-9]*/"duration_ms":0/' \
+          -e 's/duration_ms: [0-9]*\.[0-9]*$/duration_ms: 0/' \
+          -e 's/ time="[0-9]*\.[0-9]*"/ time="0"/'
+}
+
+expected='
+{"suite":"basic","case":"addition","func":"suite_basic.case_add","status":"passed","file":"test.c","line":null,"message":null,"duration_ms":0}
+{"suite":"basic","case":"subtraction","func":"suite_basic.case_sub","status":"passed","file":"test.c","line":null,"message":null,"duration_ms":0}
+{"suite":"basic","case":"division","func":"suite_basic.case_div","status":"failed","file":"test.c","line":21,"message":"1 / 2 == 0.5","duration_ms":0}
+{"suite":"basic","case":"multiplication","func":"suite_basic.case_mul","status":"passed","file":"test.c","line":null,"message":null,"duration_ms":0}
+{"suite":"advanced","case":"answer","func":"suite_advanced.case_answer","status":"passed","file":"test.c","line":null,"message":null,"duration_ms":0}
+{"suite":"advanced","case":"fizzbuzz","func":"suite_advanced.case_fizzbuzz","status":"passed","file":"test.c","line":null,"message":null,"duration_ms":0}
+{"suite":"more","case":"more","func":"suite_more.case_more","status":"todo","file":"test.c","line":null,"message":null,"duration_ms":0}
+{"suite":"more","case":null,"func":"suite_more","status":"todo"}
+{"total":6,"passed":5,"failed":1,"todo":1,"duration_ms":0}
+'
+[ "${expected%?}" = "$(records --format=jsonl)" ]
+[ "${expected%?}" = "$(records -q -j 3 -i -f jsonl -S 0)" ]
+
+expected='
+TAP version 13
+ok - basic : addition
+  ---
+  func: suite_basic.case_add
+  file: "test.c"
+  duration_ms: 0
+  ...
+not ok - basic : division
+  ---
+  func: suite_basic.case_div
+  file: "test.c"
+  line: 21
+  message: "1 / 2 == 0.5"
+  duration_ms: 0
+  ...
+not ok - more : more # TODO
+  ---
+  func: suite_more.case_more
+  file: "test.c"
+  duration_ms: 0
+  ...
+# TODO suite_more -- more
+1..3
+# Total / Passed / Failed: 2 / 1 / 1
+'
+[ "${expected%?}" = "$(records -f tap -c addition -c division -s more)" ]
+[ "${expected%?}" = "$(records -j 2 --format tap -c case_add -c case_div -s more)" ]
+
+expected='
+<?xml version="1.0" encoding="UTF-8"?>
+<testsuites>
+<testsuite name="test.h">
+<testcase classname="basic" name="division" file="test.c" line="21" time="0"><failure message="1 / 2 == 0.5">suite_basic.case_div</failure></testcase>
+<testcase classname="advanced" name="answer" file="test.c" time="0"/>
+<testcase classname="more" name="more" file="test.c" time="0"><skipped message="TODO"/></testcase>
+<!-- TODO suite_more -->
+</testsuite>
+</testsuites>
+'
+[ "${expected%?}" = "$(records -f junit -c division -c answer -c more)" ]
 
 expected='
 [TEST] basic : addition ... PASSED
@@ -53,6 +125,7 @@ expected='
 [INFO] Total / Passed / Failed: 4 / 3 / 1
 '
 [ "${expected%?}" = "$(test -s basic)" ]
+[ "${expected%?}" = "$(test -s basic -i)" ]
 [ "${expected%?}" = "$(test -s suite_basic)" ]
 
 expected='
@@ -78,6 +151,7 @@ expected='
 [INFO] Total / Passed / Failed: 3 / 2 / 1
 '
 [ "${expected%?}" = "$(test -s basic -c division -s advanced)" ]
+[ "${expected%?}" = "$(test -j 3 -s basic -c division -s advanced)" ]
 [ "${expected%?}" = "$(test -s suite_basic -c case_div -s suite_advanced)" ]
 
 expected='
@@ -106,3 +180,90 @@ expected='
 '
 [ "${expected%?}" = "$(test -s basic -c division -c answer --)" ]
 [ "${expected%?}" = "$(test -s basic -c case_div -c case_answer --)" ]
+
+expected='
+[TEST] basic : addition ... PASSED
+[TEST] basic : subtraction ... PASSED
+[INFO] Total / Passed / Failed: 2 / 2 / 0
+'
+[ "${expected%?}" = "$(test -s 'suite_b*' -x division -x 'mul*')" ]
+[ "${expected%?}" = "$(test -s basic -c '*tion' --exclude case_mul)" ]
+[ "${expected%?}" = "$(test -s basic -c 'case_?d*' -c 'case_s?b')" ]
+
+expected='
+[TEST] advanced : fizzbuzz ... PASSED
+[TEST] suite_more -- more ... TODO
+[INFO] Total / Passed / Failed: 1 / 1 / 0
+'
+[ "${expected%?}" = "$(test -c 'f*' -x 'a*')" ]
+[ "${expected%?}" = "$(test -j 2 -x '*i*i*' -c '*z*' -x case_answer)" ]
+
+expected='
+[TEST] suite_more -- more ... TODO
+[INFO] Total / Passed / Failed: 0 / 0 / 0
+'
+[ "${expected%?}" = "$(test -x '*')" ]
+[ "${expected%?}" = "$(test -c 'f*' -x 'case_*')" ]
+
+case "${BIN}" in
+  *-auto)  # the registry, in the order of definition
+expected='
+[TEST] addition (case_add at test.c#L7)
+[TEST] subtraction (case_sub at test.c#L11)
+[TEST] multiplication (case_mul at test.c#L15)
+[TEST] division (case_div at test.c#L19)
+[SUITE] basic (suite_basic at test.c#L23)
+[TEST] answer (case_answer at test.c#L30)
+[TEST] fizzbuzz (case_fizzbuzz at test.c#L34)
+[SUITE] advanced (suite_advanced at test.c#L42)
+[TEST] more (case_more at test.c#L48)
+[SUITE] more (suite_more at test.c#L51)
+'
+[ "${expected%?}" = "$(test --list)" ]
+[ "${expected%?}" = "$(test -j 2 -i -f jsonl -l)" ]
+
+expected='
+[TEST] subtraction (case_sub at test.c#L11)
+[TEST] multiplication (case_mul at test.c#L15)
+[SUITE] basic (suite_basic at test.c#L23)
+[TEST] more (case_more at test.c#L48)
+[SUITE] more (suite_more at test.c#L51)
+'
+[ "${expected%?}" = "$(test -l -s basic -x 'case_*d*' -x 'case_*n*' -x 'case_f*' \
+                            -s suite_more)" ]
+    ;;
+  *)
+expected='
+[SUITE] basic (suite_basic at test.c#L23)
+[TEST] basic : addition (case_add at test.c#L7)
+[TEST] basic : subtraction (case_sub at test.c#L11)
+[TEST] basic : division (case_div at test.c#L19)
+[TEST] basic : multiplication (case_mul at test.c#L15)
+[SUITE] advanced (suite_advanced at test.c#L42)
+[TEST] advanced : answer (case_answer at test.c#L30)
+[TEST] advanced : fizzbuzz (case_fizzbuzz at test.c#L34)
+[SUITE] more (suite_more at test.c#L51)
+[TEST] more : more (case_more at test.c#L48)
+'
+[ "${expected%?}" = "$(test --list)" ]
+[ "${expected%?}" = "$(test -j 2 -i -f jsonl -l)" ]
+
+expected='
+[SUITE] basic (suite_basic at test.c#L23)
+[TEST] basic : subtraction (case_sub at test.c#L11)
+[TEST] basic : multiplication (case_mul at test.c#L15)
+[SUITE] more (suite_more at test.c#L51)
+'
+[ "${expected%?}" = "$(test -l -s basic -x 'case_*d*' -s suite_more -c none)" ]
+    ;;
+esac
+
+expected='[INFO] Total / Passed / Failed: 6 / 5 / 1'
+[ "${expected}" = "$("${0%/*}/shard.sh" 3 "${BIN}" | grep '^\[INFO\] Total')" ]
+[ "${expected}" = "$("${0%/*}/shard.sh" 8 "${BIN}" -j 2 | grep '^\[INFO\] Total')" ]
+[ "$(test | grep '^\[TEST\]' | sort)" \
+  = "$("${0%/*}/shard.sh" 2 "${BIN}" -i | grep '^\[TEST\]' | sort)" ]
+[ "$(test -l | sort)" \
+  = "$(for i in 0 1 2 3; do test -l --shard-index $i --shard-count 4; done \
+       | sort -u)" ]
+! "${BIN}" --shard-index 3 --shard-count 3 >/dev/null 2>&1
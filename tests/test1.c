@@ -1,3 +1,7 @@
+#if defined(__linux__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime in test.h */
+#endif
+
 #ifdef TEST_H_DEBUGGING
 #line 3 "test.c"
 #endif
@@ -55,7 +59,11 @@ TEST_SUITE("more", suite_more) {
 
 TEST_MAIN {
     int answer = 42;
+#ifdef TEST_H_AUTO
+    RUN_ALL(&answer);
+#else
     RUN(suite_basic, NULL);
     RUN(suite_advanced, &answer);
     RUN(suite_more, NULL);
+#endif
 }
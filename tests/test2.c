@@ -1,3 +1,7 @@
+#ifdef __linux__
+#define _GNU_SOURCE  /* clock_gettime and sched_setaffinity in test.h */
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,12 +10,29 @@
 #include <inttypes.h>
 
 #define ARGVE_H_WITH_IMPLEMENTATION
+#define ARGVE_H_WITH_ADAPTIVE
+#define ARGVE_H_WITH_BLOOM
+#define ARGVE_H_WITH_KINDS
+#define ARGVE_H_WITH_PRESCAN
+#define ARGVE_H_WITH_INDEX
+#define ARGVE_INDEX_MIN_SHORT 0  /* the index of any table to be tested */
+#define ARGVE_INDEX_MIN_LONG 0
+#define ARGVE_H_WITH_DFA
+#define ARGVE_H_WITH_HOOKS
+#define ARGVE_H_WITH_RUN
+#define ARGVE_H_WITH_CHOICES
+#define ARGVE_H_WITH_PAIRS
+#define ARGVE_H_WITH_SUGGEST
+#define ARGVE_H_WITH_MANY
+#define ARGVE_H_WITH_BUILDER
+#define ARGVE_H_WITH_SNAPSHOT
 #define ARGVE_H_API static
 #include <argve.h>
 
 #include <test.h>
 
 #include "sfc.c"
+#include "spec.c"  /* generated from tests/spec.txt */
 
 #define ERROR_EXIT(x) \
     do { \
@@ -66,6 +87,38 @@ void set_args(char **argv, int *argc, ...)
 
 #define EXPECT_STRING(a, b) ASSERT(strcmp(a, b) == 0)
 
+#define SAME_STATE(a, b) \
+    ((a).options == (b).options \
+     && (a).option == (b).option \
+     && (a).optstr == (b).optstr \
+     && (a).argstr == (b).argstr \
+     && (a).argv == (b).argv \
+     && (a).argc == (b).argc \
+     && (a).type == (b).type)
+
+/* fill argv and options with random bytes carved from <memory> */
+static void fuzz_args(sfc64 *rng, char *memory, int size,
+                      char **argv, int argc, argve_option *options,
+                      int max_arg_size, int max_flag_size)
+{
+    int i, j, k = size; char *s;
+
+    for (i = 0; i < size; i++) memory[i] = sfc64_rand(rng, 256);
+
+    for (i = 0; i < argc; i++) {
+        j = 1 + sfc64_rand(rng, max_arg_size);
+        argv[i] = memory + (k -= j);  /* allocate memory */
+        argv[i][j - 1] = '\0';
+    }
+    for (i = 0; i < MAX_OPTS; i++) {
+        j = 1 + sfc64_rand(rng, max_flag_size);
+        s = memory + (k -= j);  /* allocate memory */
+        SET_OPTION(i, 1, s[0], s);
+        s[j - 1] = '\0';
+        options[i].longopt = argve_to_long_opt(s, 0);
+    }
+}
+
 TEST_CASE("state = NULL", case_init_1) {
     SETUP_WITH_ARGV(2);
     set_args(argv, &argc, "trivial", NULL);
@@ -818,21 +871,8 @@ TEST_CASE("fuzzing", case_fuzzing_1) {
     ASSERT((memory = (char *)malloc(k)) != NULL);
 
     while (rounds-- > 0) {
-        k = c;
-        for (i = 0; i < c; i++) memory[i] = sfc64_rand(&rng, 256);
-
-        for (i = 0; i < argc; i++) {
-            j = 1 + sfc64_rand(&rng, max_arg_size);
-            argv[i] = memory + (k -= j);  /* allocate memory */
-            argv[i][j - 1] = '\0';
-        }
-        for (i = 0; i < MAX_OPTS; i++) {
-            j = 1 + sfc64_rand(&rng, max_flag_size);
-            s = memory + (k -= j);  /* allocate memory */
-            SET_OPTION(i, 1, s[0], s);
-            s[j - 1] = '\0';
-            options[i].longopt = argve_to_long_opt(s, 0);
-        }
+        fuzz_args(&rng, memory, c, argv, argc, options,
+                  max_arg_size, max_flag_size);
         ASSERT_OR_GOTO(argve_init(&state, options, argc, argv), error);
 
         for (i = 0; i < argc && state.argc > 0; i++) {
@@ -852,6 +892,1447 @@ error:
     free(memory);
 }
 
+TEST_CASE("argve_adaptive_init", case_adaptive_1) {
+    argve_adaptive adaptive;
+    argve_slot slots[4];
+    SETUP_WITH_ARGV(1);
+
+    SET_OPTION(0, 0, 'a', "one");
+    SET_OPTION(1, 1, 'b', "two");
+    SET_OPTION(2, 1, 'a', "two");
+    SET_OPTION(3, 0, 'c', "one");
+    ASSERT(!argve_adaptive_init(NULL, options, slots, 4, 1));
+    ASSERT(!argve_adaptive_init(&adaptive, NULL, slots, 4, 1));
+    ASSERT(!argve_adaptive_init(&adaptive, options, NULL, 4, 1));
+    ASSERT(!argve_adaptive_init(&adaptive, options, slots, 3, 1));
+    ASSERT(argve_adaptive_init(&adaptive, options, slots, 4, 1));
+    ASSERT(adaptive.options == options);
+    ASSERT(adaptive.slots == slots);
+    ASSERT(adaptive.count == 4);
+    for (i = 0; i < 4; i++) {
+        ASSERT(slots[i].index == i);
+        ASSERT(slots[i].hits == 0);
+    }
+    ASSERT(slots[0].shadowed == 0);
+    ASSERT(slots[1].shadowed == 0);
+    ASSERT(slots[2].shadowed == 3);
+    ASSERT(slots[3].shadowed == 2);
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(state.adaptive == NULL);
+}
+
+TEST_CASE("hot flags first", case_adaptive_2) {
+    char *names[] = {
+        "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+        "hotel", "india", "juliett", "kilo", "lima", "mike", "november",
+        "oscar", "papa", "quebec", "romeo", "sierra", "tango", "uniform",
+        "victor", "whiskey", "xray", "yankee", "zulu", NULL
+    };
+    argve_adaptive adaptive;
+    argve_slot slots[26];
+    argve_state plain;
+    SETUP_WITH_ARGV(256);
+
+    for (i = 0; names[i] != NULL; i++) {
+        SET_OPTION(i, 0, 'a' + i, names[i]);
+    }
+    for (i = 0; i < argc; i++) {
+        k = i % 8;
+        argv[i] = k < 4 ? "-z" : (k < 6 ? "--yankee=" : (k < 7 ? "-a" : "-"));
+    }
+    ASSERT(argve_adaptive_init(&adaptive, options, slots, 26, 16));
+
+    for (k = 0; k < 2; k++) {
+        ASSERT(argve_init(&plain, options, argc, argv));
+        ASSERT(argve_init(&state, options, argc, argv));
+        state.adaptive = &adaptive;
+        do {
+            type = argve_next(&state);
+            ASSERT(argve_next(&plain) == type);
+            ASSERT(SAME_STATE(state, plain));
+        } while (type != ARGVE_END);
+    }
+    ASSERT(slots[0].index == 25);
+    ASSERT(slots[1].index == 24);
+    ASSERT(slots[2].index == 0);
+    for (i = 3; i < 26; i++) {
+        ASSERT(slots[i].index == i - 2);
+    }
+}
+
+TEST_CASE("shadowed flags", case_adaptive_3) {
+    argve_adaptive adaptive;
+    argve_slot slots[4];
+    argve_state plain;
+    SETUP_WITH_ARGV(256);
+
+    SET_OPTION(0, 0, 'a', "one");
+    SET_OPTION(1, 1, 'b', "two");
+    SET_OPTION(2, 1, 'a', "two");
+    SET_OPTION(3, 0, 'c', "one");
+    for (i = 0; i < argc; i++) {
+        argv[i] = i % 3 == 0 ? "-ca" : (i % 3 == 1 ? "--two" : "--one");
+    }
+    ASSERT(argve_adaptive_init(&adaptive, options, slots, 4, 1));
+    ASSERT(argve_init(&plain, options, argc, argv));
+    ASSERT(argve_init(&state, options, argc, argv));
+    state.adaptive = &adaptive;
+    do {
+        type = argve_next(&state);
+        ASSERT(argve_next(&plain) == type);
+        ASSERT(SAME_STATE(state, plain));
+    } while (type != ARGVE_END);
+    ASSERT(slots[3].index == 2);
+}
+
+TEST_CASE("argve_bloom_init", case_bloom_1) {
+    argve_bloom bloom;
+    unsigned char memory[100];
+    SETUP_WITH_ARGV(1);
+
+    SET_OPTION(0, 0, 'a', "one");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 0, "three");
+    ASSERT(!argve_bloom_init(NULL, options, memory, sizeof(memory)));
+    ASSERT(!argve_bloom_init(&bloom, NULL, memory, sizeof(memory)));
+    ASSERT(!argve_bloom_init(&bloom, options, NULL, sizeof(memory)));
+    ASSERT(!argve_bloom_init(&bloom, options, memory, 0));
+    ASSERT(argve_bloom_init(&bloom, options, memory, 1));
+    ASSERT(bloom.mask == 7);
+    ASSERT(argve_bloom_init(&bloom, options, memory, sizeof(memory)));
+    ASSERT(bloom.options == options);
+    ASSERT(bloom.bits == memory);
+    ASSERT(bloom.mask == 64 * 8 - 1);
+    ASSERT(argve_bloom_test(&bloom, "one"));
+    ASSERT(argve_bloom_test(&bloom, "one=1"));
+    ASSERT(argve_bloom_test(&bloom, "three"));
+    ASSERT(argve_bloom_test(&bloom, "three="));
+    for (i = j = 0; i < 64; i++) j += memory[i] != 0;
+    ASSERT(1 <= j && j <= 4);
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(state.bloom == NULL);
+}
+
+TEST_CASE("unknown long flags", case_bloom_2) {
+    char *names[] = {
+        "--one", "--one=", "--one=1", "--two", "--two=2", "--three",
+        "--three=", "--three=3", "--", "---", "--=", "--one ", "--on", NULL
+    };
+    argve_bloom bloom;
+    unsigned char memory[4];
+    argve_state plain;
+    SETUP_WITH_ARGV(256);
+
+    SET_OPTION(0, 0, 'a', "one");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 0, "three");
+    for (i = 0; i < argc; i++) {
+        argv[i] = names[i % (sizeof(names) / sizeof(*names) - 1)];
+    }
+    for (k = 1; k <= 4; k++) {
+        ASSERT(argve_bloom_init(&bloom, options, memory, k));
+        ASSERT(argve_init(&plain, options, argc, argv));
+        ASSERT(argve_init(&state, options, argc, argv));
+        state.bloom = &bloom;
+        do {
+            type = argve_next(&state);
+            ASSERT(argve_next(&plain) == type);
+            ASSERT(SAME_STATE(state, plain));
+        } while (type != ARGVE_END);
+    }
+}
+
+TEST_CASE("argve_index_init", case_index_1) {
+    argve_index index;
+    argve_name names[4];
+    unsigned long shorts[ARGVE_INDEX_WORDS(4)];
+    SETUP_WITH_ARGV(1);
+
+    SET_OPTION(0, 0, 'a', "one");
+    SET_OPTION(1, 1, 'b' + 256, NULL);
+    SET_OPTION(2, 1, '-', "three");
+    SET_OPTION(3, 1, 'a', "three");
+    ASSERT(sizeof(shorts) == 16);
+    ASSERT(!argve_index_init(NULL, options, names, shorts, 4));
+    ASSERT(!argve_index_init(&index, NULL, names, shorts, 4));
+    ASSERT(!argve_index_init(&index, options, NULL, shorts, 4));
+    ASSERT(!argve_index_init(&index, options, names, NULL, 4));
+    ASSERT(!argve_index_init(&index, options, names, shorts, 3));
+    ASSERT(argve_index_init(&index, options, names, shorts, 4));
+    ASSERT(index.options == options);
+    ASSERT(index.names == names);
+    ASSERT(index.shorts == shorts);
+    ASSERT(index.count == 4);
+    ASSERT(names[0].length == 3 && names[0].name == options[0].longopt);
+    ASSERT(names[1].length == 0 && names[1].name == NULL);
+    ASSERT(names[2].length == 5 && names[3].length == 5);
+    ASSERT(argve_index_short(&index, 'a') == options);
+    ASSERT(argve_index_short(&index, 'b') == NULL);
+    ASSERT(argve_index_short(&index, '-') == NULL);
+    ASSERT(argve_index_short(&index, 0) == NULL);
+    ASSERT(argve_index_long(&index, "--one") == options);
+    ASSERT(argve_index_long(&index, "--one=") == options);
+    ASSERT(argve_index_long(&index, "--three=3") == options + 2);
+    ASSERT(argve_index_long(&index, "--thre") == NULL);
+    ASSERT(argve_index_long(&index, "--threes") == NULL);
+    ASSERT(argve_index_long(&index, "--") == NULL);
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(state.index == NULL);
+}
+
+TEST_CASE("every short flag", case_index_2) {
+    argve_index index;
+    argve_name names[MAX_OPTS];
+    unsigned long shorts[ARGVE_INDEX_WORDS(MAX_OPTS)];
+    char flag[3] = "-?";
+    SETUP_WITH_ARGV(1);
+
+    /* every count crosses a different word boundary */
+    for (k = 0; k <= MAX_OPTS; k += 1 + k / 4) {
+        memset(&options, 0, sizeof(options));
+        for (i = 0; i < k; i++) {
+            SET_OPTION(i, 0, (i * 37 + k) % 300 - 20, NULL);
+        }
+        ASSERT(argve_index_init(&index, options, names, shorts, MAX_OPTS));
+        for (c = 0; c < 256; c++) {
+            flag[1] = (char)c;
+            ASSERT(argve_index_short(&index, argve_to_short_opt(flag[1]))
+                   == argve_match_short(options,
+                                        argve_to_short_opt(flag[1])));
+        }
+    }
+}
+
+TEST_CASE("special arguments", case_dfa_1) {
+    char *names[] = {
+        "", "-", "--", "---", "--=", "---=", "-=", "-=x", "-a", "-a-",
+        "-ab", "-abc", "-ba=", "-a=", "-ax", "-x", "-\x7F", "-\xFF", "-a\x01",
+        "-a b", "--one", "--one=", "--one=1", "--one==", "--one-", "--two",
+        "--two=2", "--=one", "one", "a-", NULL
+    };
+    argve_state dfa;
+    int n = sizeof(names) / sizeof(*names) - 1;
+    SETUP_WITH_ARGV(64);
+
+    SET_OPTION(1, 0, 'b', NULL);
+    SET_OPTION(2, 0, '=', "two");
+    for (k = 0; k < 8 * n; k++) {
+        SET_OPTION(0, k / n % 2, 'a', "one");
+        options[1].need_arg = k / n / 2 % 2;
+        options[2].need_arg = k / n / 4 % 2;
+        argc = n - k % n;
+        for (i = 0; i < argc; i++) {
+            argv[i] = names[(k + i) % n];
+        }
+        ASSERT(argve_init(&state, options, argc, argv));
+        ASSERT(argve_init(&dfa, options, argc, argv));
+        do {
+            type = argve_next(&state);
+            ASSERT(argve_next_dfa(&dfa) == type);
+            ASSERT(SAME_STATE(dfa, state));
+        } while (type != ARGVE_END);
+    }
+}
+
+TEST_CASE("generated matchers", case_hooks_1) {
+    char *extra[] = {
+        "", "-", "--", "---", "--=", "--=help", "--help=", "--help=x",
+        "--helpx", "--hel", "--h", "--he", "--he=", "--help-", "--HELP",
+        "-help", "--quote\"s", "--quote", "--back\\slash", "--what\?\?!",
+        "--a.b+c:d@e/f=1", "--0123456789", "--012345678", "--dup",
+        "--long-only", "--long-only=", "--\x7F", "--\xFF", NULL
+    };
+    char buffer[64];
+    SETUP_WITH_ARGV(1);
+
+    for (c = -1; c < 512; c++) {
+        ASSERT(spec_match_short(spec_options, c)
+               == argve_match_short(spec_options, c));
+    }
+    ASSERT(spec_match_short(spec_options, 'q') == spec_options + SPEC_QUIET);
+    ASSERT(spec_match_short(spec_options, 300)
+           == spec_options + SPEC_VIRTUAL);
+    ASSERT(spec_match_short(NULL, 'h') == NULL);
+
+    for (i = 0; i < SPEC_COUNT; i++) {
+        if ((s = spec_options[i].longopt) == NULL) {
+            continue;
+        }
+        for (k = 0; k < 4; k++) {
+            sprintf(buffer, "--%s%s", s, k == 0 ? "" : k == 1 ? "="
+                                         : k == 2 ? "=v" : "x");
+            ASSERT(spec_match_long(spec_options, buffer)
+                   == argve_match_long(spec_options, buffer));
+            buffer[strlen(s) + 1] = '\0';
+            ASSERT(spec_match_long(spec_options, buffer)
+                   == argve_match_long(spec_options, buffer));
+        }
+    }
+    for (i = 0; extra[i] != NULL; i++) {
+        ASSERT(spec_match_long(spec_options, extra[i])
+               == argve_match_long(spec_options, extra[i]));
+    }
+    ASSERT(spec_match_long(spec_options, "--help")
+           == spec_options + SPEC_HELP);
+    ASSERT(spec_match_long(spec_options, "--he")
+           == spec_options + SPEC_PREFIX);
+    ASSERT(spec_match_long(spec_options, NULL) == NULL);
+    ASSERT(spec_match_long(NULL, "--help") == NULL);
+
+    ASSERT(argve_init(&state, spec_options, argc, argv));
+    ASSERT(state.match_short == NULL);
+    ASSERT(state.match_long == NULL);
+}
+
+TEST_CASE("argve_choices_init", case_choices_1) {
+    const char *names[] = {"debug", "info", "warn", "", "info", NULL};
+    argve_choices choices;
+    int slots[16];
+    SETUP_WITH_ARGV(1);
+
+    ASSERT(!argve_choices_init(NULL, names, slots, 16));
+    ASSERT(!argve_choices_init(&choices, NULL, slots, 16));
+    ASSERT(!argve_choices_init(&choices, names, NULL, 16));
+    ASSERT(!argve_choices_init(&choices, names, slots, 0));
+    ASSERT(!argve_choices_init(&choices, names, slots, 5));
+    ASSERT(argve_choices_init(&choices, names, slots, 15));
+    ASSERT(choices.mask == 7);
+    ASSERT(argve_choices_init(&choices, names, slots, 16));
+    ASSERT(choices.names == names);
+    ASSERT(choices.slots == slots);
+    ASSERT(choices.mask == 15);
+    ASSERT(choices.count == 5);
+    for (i = j = 0; i < 16; i++) j += slots[i] >= 0;
+    ASSERT(j == 4);
+    ASSERT(argve_choice_find(&choices, "debug") == 0);
+    ASSERT(argve_choice_find(&choices, "info") == 1);
+    ASSERT(argve_choice_find(&choices, "warn") == 2);
+    ASSERT(argve_choice_find(&choices, "") == 3);
+    ASSERT(argve_choice_find(&choices, "inf") == -1);
+    ASSERT(argve_choice_find(&choices, "infos") == -1);
+    ASSERT(argve_choice_find(&choices, "DEBUG") == -1);
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(state.choices == NULL);
+    ASSERT(state.choice == -1);
+}
+
+TEST_CASE("arguments out of choices", case_choices_2) {
+    const char *levels[] = {"debug", "info", "warn", NULL};
+    const char *formats[] = {"json", "csv", NULL};
+    const argve_choices *sets[4];
+    argve_choices level, format;
+    int slots[8], slots2[4];
+    argve_token token;
+    argve_state copy;
+    char buffer[256];
+    FILE *stream;
+    SETUP_WITH_ARGV(16);
+
+    set_args(argv, &argc, "-ldebug", "--level", "warn", "-vlinfo", "x",
+             "--format=csv", "-f", "xml", "--level=", "-vvl", "debug",
+             "-o", "any", NULL);
+    SET_OPTION(0, 1, 'l', "level");
+    SET_OPTION(1, 1, 'f', "format");
+    SET_OPTION(2, 0, 'v', NULL);
+    SET_OPTION(3, 1, 'o', NULL);
+    ASSERT(argve_choices_init(&level, levels, slots, 8));
+    ASSERT(argve_choices_init(&format, formats, slots2, 4));
+    sets[0] = &level;
+    sets[1] = &format;
+    sets[2] = NULL;
+    sets[3] = NULL;
+    ASSERT(argve_init(&state, options, argc, argv));
+    state.choices = sets;
+
+#define EXPECT_CHOICE(t, opt, arg, n) \
+    do { \
+        ASSERT(argve_next(&state) == (t)); \
+        ASSERT(state.option == options + (opt)); \
+        EXPECT_STRING(arg, state.argstr); \
+        ASSERT(state.choice == (n)); \
+        argve_to_token(&state, argv, &token); \
+        copy = state; copy.choice = -2; \
+        copy.argv = argv; copy.argc = argc; \
+        argve_from_token(&copy, argv, &token); \
+        ASSERT(SAME_STATE(copy, state) && copy.choice == state.choice); \
+    } while (0)
+
+    EXPECT_CHOICE(ARGVE_SHORT, 0, "debug", 0);
+    EXPECT_CHOICE(ARGVE_LONG, 0, "warn", 2);
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    ASSERT(state.choice == -1);
+    EXPECT_CHOICE(ARGVE_CLUSTER, 0, "info", 1);
+    ASSERT(argve_next(&state) == ARGVE_TEXT);
+    ASSERT(state.choice == -1);
+    EXPECT_CHOICE(ARGVE_LONG, 1, "csv", 1);
+    EXPECT_CHOICE(ARGVE_ERR_CHOICE, 1, "xml", -1);
+    ASSERT(argve_error(&state));
+    ASSERT((stream = tmpfile()) != NULL);
+    ASSERT(argve_perror(&state, "[E] ", stream) == 45);
+    EXPECT_CHOICE(ARGVE_ERR_CHOICE, 0, "", -1);
+    ASSERT(argve_perror(&state, "[E] ", stream) == 54);
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    EXPECT_CHOICE(ARGVE_CLUSTER, 0, "debug", 0);
+    EXPECT_CHOICE(ARGVE_SHORT, 3, "any", -1);
+    ASSERT(argve_next(&state) == ARGVE_END);
+    ASSERT(state.choice == -1);
+#undef EXPECT_CHOICE
+
+    rewind(stream);
+    ASSERT(fread(buffer, 1, sizeof(buffer), stream) == 45 + 54);
+    buffer[45 + 54] = '\0';
+    EXPECT_STRING("[E] invalid argument for -f : xml (json|csv)\n"
+                  "[E] invalid argument for --level :  (debug|info|warn)\n",
+                  buffer);
+    fclose(stream);
+}
+
+TEST_CASE("key=value pairs", case_pairs_1) {
+    const unsigned char pairs[4] = {1, 1, 0, 0};
+    argve_state dfa;
+    SETUP_WITH_ARGV(16);
+
+    set_args(argv, &argc, "-Dname=value", "--set", "a.b.c=1", "-vDNDEBUG",
+             "--set=k==", "-D", "=x", "-o", "k=v", "-D=", "--set=a=1",
+             "-vv", "--set", NULL);
+    SET_OPTION(0, 1, 'D', "define");
+    SET_OPTION(1, 1, 0, "set");
+    SET_OPTION(2, 0, 'v', NULL);
+    SET_OPTION(3, 1, 'o', NULL);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(state.pairs == NULL);
+    ASSERT(state.valstr == NULL);
+    ASSERT(state.keylen == -1);
+    ASSERT(argve_init(&dfa, options, argc, argv));
+    state.pairs = pairs;
+    dfa.pairs = pairs;
+
+#define EXPECT_PAIR(t, opt, arg, n, val) \
+    do { \
+        ASSERT(argve_next(&state) == (t)); \
+        ASSERT(argve_next_dfa(&dfa) == (t)); \
+        ASSERT(SAME_STATE(state, dfa)); \
+        ASSERT(state.option == options + (opt)); \
+        EXPECT_STRING(arg, state.argstr); \
+        ASSERT(state.keylen == (n) && dfa.keylen == (n)); \
+        ASSERT(state.valstr == dfa.valstr); \
+        if ((s = (val)) != NULL) { \
+            ASSERT(state.valstr == state.argstr + (n) + 1); \
+            EXPECT_STRING(s, state.valstr); \
+        } else { \
+            ASSERT(state.valstr == NULL); \
+        } \
+    } while (0)
+
+    EXPECT_PAIR(ARGVE_SHORT, 0, "name=value", 4, "value");
+    EXPECT_PAIR(ARGVE_LONG, 1, "a.b.c=1", 5, "1");
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    ASSERT(argve_next_dfa(&dfa) == ARGVE_CLUSTER);
+    ASSERT(state.keylen == -1 && dfa.keylen == -1);
+    EXPECT_PAIR(ARGVE_CLUSTER, 0, "NDEBUG", 6, NULL);
+    EXPECT_PAIR(ARGVE_LONG, 1, "k==", 1, "=");
+    EXPECT_PAIR(ARGVE_SHORT, 0, "=x", 0, "x");
+    EXPECT_PAIR(ARGVE_SHORT, 3, "k=v", -1, NULL);
+    EXPECT_PAIR(ARGVE_SHORT, 0, "=", 0, "");
+    EXPECT_PAIR(ARGVE_LONG, 1, "a=1", 1, "1");
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    ASSERT(argve_next_dfa(&dfa) == ARGVE_CLUSTER);
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    ASSERT(argve_next_dfa(&dfa) == ARGVE_CLUSTER);
+    ASSERT(state.keylen == -1 && dfa.keylen == -1);
+    ASSERT(argve_next(&state) == ARGVE_ERR_ARG_LONG);
+    ASSERT(argve_next_dfa(&dfa) == ARGVE_ERR_ARG_LONG);
+    ASSERT(state.keylen == -1 && dfa.keylen == -1);
+    ASSERT(state.valstr == NULL && dfa.valstr == NULL);
+    ASSERT(argve_next(&state) == ARGVE_END);
+    ASSERT(argve_next_dfa(&dfa) == ARGVE_END);
+    ASSERT(state.keylen == -1 && dfa.keylen == -1);
+#undef EXPECT_PAIR
+}
+
+TEST_CASE("argve_pairs_add", case_pairs_2) {
+    const unsigned char flags[2] = {1, 0};
+    argve_pairs pairs;
+    argve_pair memory[3];
+    int slots[6];
+    SETUP_WITH_ARGV(16);
+
+    set_args(argv, &argc, "-DA=1", "-DB", "-o", "A=0", "-DA=2", "-D=",
+             "-DB=3", "-DC=4", "-D=5", NULL);
+    SET_OPTION(0, 1, 'D', "define");
+    SET_OPTION(1, 1, 'o', NULL);
+    ASSERT(!argve_pairs_init(NULL, memory, slots, 3));
+    ASSERT(!argve_pairs_init(&pairs, NULL, slots, 3));
+    ASSERT(!argve_pairs_init(&pairs, memory, NULL, 3));
+    ASSERT(!argve_pairs_init(&pairs, memory, slots, 0));
+    ASSERT(argve_pairs_init(&pairs, memory, slots, 3));
+    ASSERT(pairs.pairs == memory);
+    ASSERT(pairs.slots == slots);
+    ASSERT(pairs.mask == 3);
+    ASSERT(pairs.count == 0);
+    ASSERT(pairs.size == 3);
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    state.pairs = flags;
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == 0);
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == 1);
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == -1);
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == 0);
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == 2);
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == 1);
+    /* full */
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == -1);
+    ASSERT(argve_next(&state) == ARGVE_SHORT);
+    ASSERT(argve_pairs_add(&pairs, &state) == 2);
+    ASSERT(argve_next(&state) == ARGVE_END);
+    ASSERT(argve_pairs_add(&pairs, &state) == -1);
+
+    ASSERT(pairs.count == 3);
+    ASSERT(memory[0].option == options && memory[0].keylen == 1);
+    ASSERT(memory[0].key == argv[0] + 2);
+    EXPECT_STRING("2", memory[0].value);
+    ASSERT(memory[1].keylen == 1 && memory[1].key == argv[1] + 2);
+    EXPECT_STRING("3", memory[1].value);
+    ASSERT(memory[2].keylen == 0 && memory[2].key == argv[5] + 2);
+    EXPECT_STRING("5", memory[2].value);
+}
+
+/* the textbook dynamic programming for checking argve_suggest */
+static int levenshtein(const char *a, const char *b)
+{
+    int row[80], i, j, diagonal, up;
+    int m = (int)strlen(a), n = (int)strlen(b);
+
+    for (j = 0; j <= n; j++) {
+        row[j] = j;
+    }
+    for (i = 1; i <= m; i++) {
+        diagonal = row[0];
+        row[0] = i;
+        for (j = 1; j <= n; j++) {
+            up = row[j];
+            row[j] = diagonal + (a[i - 1] != b[j - 1]);
+            if (row[j] > up + 1) row[j] = up + 1;
+            if (row[j] > row[j - 1] + 1) row[j] = row[j - 1] + 1;
+            diagonal = up;
+        }
+    }
+    return row[n];
+}
+
+TEST_CASE("did you mean", case_suggest_1) {
+    argve_suggestion found[4];
+    char buffer[256];
+    FILE *stream;
+    SETUP_WITH_ARGV(8);
+
+    SET_OPTION(0, 0, 'v', "verbose");
+    SET_OPTION(1, 0, 'V', "version");
+    SET_OPTION(2, 1, 'o', "output");
+    SET_OPTION(3, 0, 'h', "help");
+    SET_OPTION(4, 0, 0, "verbose");
+    SET_OPTION(5, 1, 'x', NULL);
+    ASSERT(argve_suggest(NULL, "help", found, 4) == 0);
+    ASSERT(argve_suggest(options, NULL, found, 4) == 0);
+    ASSERT(argve_suggest(options, "help", NULL, 4) == 0);
+    ASSERT(argve_suggest(options, "help", found, 0) == 0);
+    ASSERT(argve_suggest(options, "", found, 4) == 0);
+    ASSERT(argve_suggest(options, "=help", found, 4) == 0);
+    ASSERT(argve_suggest(options, "hlep", found, 4) == 1);
+    ASSERT(found[0].option == options + 3 && found[0].distance == 2);
+    ASSERT(argve_suggest(options, "verison=1", found, 4) == 1);
+    ASSERT(found[0].option == options + 1 && found[0].distance == 2);
+    ASSERT(argve_suggest(options, "verbse", found, 4) == 2);
+    ASSERT(found[0].option == options + 0 && found[0].distance == 1);
+    ASSERT(found[1].option == options + 4 && found[1].distance == 1);
+    ASSERT(argve_suggest(options, "verbos", found, 4) == 3);
+    ASSERT(found[0].option == options + 0 && found[0].distance == 1);
+    ASSERT(found[1].option == options + 4 && found[1].distance == 1);
+    ASSERT(found[2].option == options + 1 && found[2].distance == 3);
+    ASSERT(argve_suggest(options, "verbos", found, 2) == 2);
+    ASSERT(found[1].option == options + 4 && found[1].distance == 1);
+    ASSERT(argve_suggest(options, "verbos", found, 1) == 1);
+    ASSERT(found[0].option == options + 0 && found[0].distance == 1);
+    ASSERT(argve_suggest(options, "xyz", found, 4) == 0);
+
+    set_args(argv, &argc, "--verbsoe", "-utput", "-vq", "--zzz=1", NULL);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT((stream = tmpfile()) != NULL);
+    ASSERT(argve_next(&state) == ARGVE_ERR_DEF_LONG);
+    c = argve_perror(&state, "", stream);
+    ASSERT(argve_next(&state) == ARGVE_ERR_DEF_SHORT);
+    c += argve_perror(&state, "", stream);
+    ASSERT(argve_next(&state) == ARGVE_CLUSTER);
+    ASSERT(argve_next(&state) == ARGVE_ERR_DEF_SHORT);
+    c += argve_perror(&state, "", stream);
+    ASSERT(argve_next(&state) == ARGVE_ERR_DEF_LONG);
+    c += argve_perror(&state, "", stream);
+    rewind(stream);
+    ASSERT(c < (int)sizeof(buffer));
+    ASSERT(fread(buffer, 1, sizeof(buffer), stream) == (size_t)c);
+    buffer[c] = '\0';
+    EXPECT_STRING("unrecognized option --verbsoe : --verbsoe\n"
+                  "did you mean --verbose?\n"
+                  "unrecognized option -u : -utput\n"
+                  "did you mean --output?\n"
+                  "unrecognized option -q : -vq\n"
+                  "unrecognized option --zzz : --zzz=1\n", buffer);
+    fclose(stream);
+}
+
+TEST_CASE("fuzzing edit distance", case_fuzzing_5) {
+    const char letters[] = "abcd-";
+    int n;
+    int rounds = 2000;
+    sfc64 rng;
+    uint64_t seed = *TEST_DATA(uint64_t *);
+    argve_suggestion found[MAX_OPTS];
+    char names[MAX_OPTS][72], name[72];
+    SETUP_WITH_ARGV(1);
+
+    sfc64_seed(&rng, seed);
+    while (rounds-- > 0) {
+        n = 1 + sfc64_rand(&rng, 64);
+        for (i = 0; i < n; i++) {
+            k = 1 + sfc64_rand(&rng, i % 8 == 0 ? 70 : 12);
+            for (j = 0; j < k; j++) {
+                names[i][j] = letters[sfc64_rand(&rng, 5)];
+            }
+            names[i][k] = '\0';
+            SET_OPTION(i, 0, 0, names[i]);
+        }
+        options[n].longopt = NULL;
+        k = 1 + sfc64_rand(&rng, sfc64_rand(&rng, 8) == 0 ? 64 : 12);
+        for (j = 0; j < k; j++) {
+            name[j] = letters[sfc64_rand(&rng, 5)];
+        }
+        name[k] = '\0';
+        c = argve_suggest(options, name, found, MAX_OPTS);
+        /* every option within the bound and nothing else */
+        for (i = j = 0; i < n; i++) {
+            j += levenshtein(name, names[i]) <= k / 3 + 1;
+        }
+        ASSERT(j == c);
+        for (i = 0; i < c; i++) {
+            j = (int)(found[i].option - options);
+            ASSERT(found[i].distance == levenshtein(name, names[j]));
+        }
+        for (i = 1; i < c; i++) {
+            ASSERT(found[i - 1].distance <= found[i].distance);
+            if (found[i - 1].distance == found[i].distance) {
+                ASSERT(found[i - 1].option < found[i].option);
+            }
+        }
+        /* the nearest one */
+        if (c > 0) {
+            ASSERT(argve_suggest(options, name, found + 1, 1) == 1);
+            ASSERT(found[1].distance == found[0].distance);
+            ASSERT(found[1].option == found[0].option);
+        }
+    }
+}
+
+/* what argve_run calls, in the same format as the loop of argve_next */
+typedef struct {
+    char log[1024];
+    int length;
+    const char *stop;  /* the value at which handlers return nonzero */
+} run_log;
+
+static int run_append(void *context, const char *tag, const char *value)
+{
+    run_log *log = (run_log *)context;
+
+    log->length += sprintf(log->log + log->length, "%s:%s;",
+                           tag, value != NULL ? value : "(null)");
+    return log->stop != NULL && value != NULL
+        && strcmp(log->stop, value) == 0;
+}
+
+static int run_a(void *context, char *value)
+{
+    return run_append(context, "a", value);
+}
+
+static int run_b(void *context, char *value)
+{
+    return run_append(context, "b", value);
+}
+
+static int run_c(void *context, char *value)
+{
+    return run_append(context, "c", value);
+}
+
+static int run_text(void *context, char *value)
+{
+    return run_append(context, "text", value);
+}
+
+static int run_error(void *context, argve_state *state)
+{
+    return run_append(context, "error", state->optstr);
+}
+
+TEST_CASE("push dispatch", case_run_1) {
+    argve_handler handlers[4];
+    argve_handlers run;
+    run_log log, pulled;
+    char *tags[] = {"a", "b", "c"};
+    SETUP_WITH_ARGV(16);
+
+    set_args(argv, &argc, "-ab1", "x", "--long", "-z", "--cc=2", "-a",
+             "--", "-b", "3", "--nope", "y", NULL);
+    SET_OPTION(0, 0, 'a', NULL);
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 0, "cc");
+    SET_OPTION(3, 0, 0, "long");
+    handlers[0] = run_a;
+    handlers[1] = run_b;
+    handlers[2] = run_c;
+    handlers[3] = NULL;
+    run.options = handlers;
+    run.text = run_text;
+    run.error = run_error;
+
+    /* the same calls as the loop of argve_next, skipping --long */
+    memset(&pulled, 0, sizeof(pulled));
+    ASSERT(argve_init(&state, options, argc, argv));
+    while (argve_next(&state) != ARGVE_END) {
+        if (argve_error(&state)) {
+            run_error(&pulled, &state);
+        } else if (state.type == ARGVE_TEXT) {
+            run_text(&pulled, state.argstr);
+        } else if (state.option - options < 3) {
+            run_append(&pulled, tags[state.option - options], state.argstr);
+        }
+    }
+    memset(&log, 0, sizeof(log));
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_run(&state, &run, &log) == ARGVE_END);
+    ASSERT_ARGVE_END;
+    EXPECT_STRING(pulled.log, log.log);
+    EXPECT_STRING("a:(null);b:1;text:x;error:z;c:2;a:(null);text:--;b:3;"
+                  "error:nope;text:y;", log.log);
+
+    /* stop at a handler */
+    memset(&log, 0, sizeof(log));
+    log.stop = "2";
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_run(&state, &run, &log) == ARGVE_LONG);
+    ASSERT(state.argv == argv + 5);
+    EXPECT_STRING("a:(null);b:1;text:x;error:z;c:2;", log.log);
+
+    /* stop at the first error, then resume */
+    memset(&log, 0, sizeof(log));
+    run.error = NULL;
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_run(&state, &run, &log) == ARGVE_ERR_DEF_SHORT);
+    ASSERT(argve_run(&state, &run, &log) == ARGVE_ERR_DEF_LONG);
+    ASSERT(argve_run(&state, &run, &log) == ARGVE_END);
+    EXPECT_STRING("a:(null);b:1;text:x;c:2;a:(null);text:--;b:3;text:y;",
+                  log.log);
+
+    /* only positional arguments */
+    memset(&log, 0, sizeof(log));
+    run.options = NULL;
+    run.error = run_error;
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_run(&state, &run, &log) == ARGVE_END);
+    EXPECT_STRING("text:x;error:z;text:--;error:nope;text:y;", log.log);
+}
+
+TEST_CASE("argve_classify", case_kinds_1) {
+    char *texts[] = {"", "-", "--", "a", "a-", "a--", "=", "=--", NULL};
+    char *shorts[] = {"-a", "-ab", "-=", "- ", "-\xFF", "-a-", "-=--", NULL};
+    char *longs[] = {"---", "--a", "--=", "-- ", "--\xFF", "----", NULL};
+    unsigned char kinds[8];
+    int i;
+
+    for (i = 0; texts[i] != NULL; i++) {
+        ASSERT(argve_kind(texts[i]) == ARGVE_TEXT);
+    }
+    for (i = 0; shorts[i] != NULL; i++) {
+        ASSERT(argve_kind(shorts[i]) == ARGVE_SHORT);
+    }
+    for (i = 0; longs[i] != NULL; i++) {
+        ASSERT(argve_kind(longs[i]) == ARGVE_LONG);
+    }
+    argve_classify(texts, 8, kinds);
+    for (i = 0; i < 8; i++) ASSERT(kinds[i] == ARGVE_TEXT);
+    argve_classify(shorts, 7, kinds);
+    for (i = 0; i < 7; i++) ASSERT(kinds[i] == ARGVE_SHORT);
+    argve_classify(longs, 6, kinds);
+    for (i = 0; i < 6; i++) ASSERT(kinds[i] == ARGVE_LONG);
+}
+
+TEST_CASE("runs of positional arguments", case_kinds_2) {
+    char *args[] = {
+        "a", "b", "-ab", "c", "-", "--", "-b", "d", "--c=-", "e", "-ba",
+        "--c", "f", "g", "-ab-", "h", NULL
+    };
+    unsigned char kinds[256];
+    argve_state plain;
+    SETUP_WITH_ARGV(256);
+
+    SET_OPTION(0, 0, 'a', NULL);
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 'c', "c");
+    for (i = 0; i < argc; i++) {
+        argv[i] = args[i % (sizeof(args) / sizeof(*args) - 1)];
+    }
+    argve_classify(argv, argc, kinds);
+    for (k = 0; k < 2; k++) {
+        ASSERT(argve_init(&plain, options, argc, argv));
+        ASSERT(argve_init(&state, options, argc, argv));
+        ASSERT(state.kinds == NULL);
+        state.kinds = k ? kinds : NULL;
+        j = 0;
+        do {
+            if ((i = argve_skip_text(&state)) > 0) {
+                j += i;
+                while (i-- > 0) {
+                    ASSERT(argve_next(&plain) == ARGVE_TEXT);
+                }
+                ASSERT(SAME_STATE(state, plain));
+                ASSERT(argve_skip_text(&state) == 0);
+            }
+            type = argve_next(&state);
+            ASSERT(argve_next(&plain) == type);
+            ASSERT(SAME_STATE(state, plain));
+            ASSERT(!k || state.kinds == kinds + (state.argv - argv));
+        } while (type != ARGVE_END);
+        ASSERT(j == argc / 16 * 7 + 6);
+    }
+}
+
+static char *token_args[] = {
+    "a", "-ab", "c", "-", "--", "-b", "d", "--c=-", "-ba", "--c", "f",
+    "-ab-", "--a", "--c=", "-x", "--xyz=1", "-ax", "--", "-aab", "-a", NULL
+};
+
+TEST_CASE("token round trip", case_tokens_1) {
+    argve_state states[512], restored;
+    argve_token tokens[512];
+    SETUP_WITH_ARGV(256);
+
+    SET_OPTION(0, 0, 'a', "a");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 'c', "c");
+    for (i = 0; i < argc; i++) {
+        argv[i] = token_args[i % (sizeof(token_args) / sizeof(char *) - 1)];
+    }
+    ASSERT(argve_init(&state, options, argc, argv));
+    argve_to_token(&state, argv, &tokens[0]);
+    ASSERT(tokens[0].type == ARGVE_ERR_UNKNOWN);
+    ASSERT(tokens[0].option == -1);
+    ASSERT(tokens[0].arg == 0 && tokens[0].next == 0);
+    ASSERT(tokens[0].optoff == -1 && tokens[0].valoff == -1);
+    states[0] = state;
+    k = 1;
+    do {
+        ASSERT(k < 512);
+        argve_next(&state);
+        states[k++] = state;
+    } while (state.type != ARGVE_END);
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_tokenize(&state, argv, tokens + 1, 10) == 10);
+    ASSERT(tokens[10].type != ARGVE_END);
+    ASSERT(argve_tokenize(&state, argv, tokens + 11, 512 - 11) == k - 11);
+    ASSERT(tokens[k - 1].type == ARGVE_END);
+    ASSERT(tokens[k - 1].next == argc);
+
+    /* restore states in random order */
+    ASSERT(argve_init(&restored, options, argc, argv));
+    for (i = 0; i < k; i++) {
+        j = (i * 7) % k;
+        argve_to_token(&states[j], argv, &tokens[0]);
+        argve_from_token(&restored, argv, &tokens[0]);
+        ASSERT(SAME_STATE(restored, states[j]));
+        if (states[j].type != ARGVE_END) {
+            type = argve_next(&restored);
+            ASSERT(SAME_STATE(restored, states[j + 1]));
+        }
+    }
+    ASSERT(tokens[1].type == ARGVE_TEXT);
+    ASSERT(tokens[1].arg == 0 && tokens[1].value == 0);
+    ASSERT(tokens[1].optoff == -1 && tokens[1].valoff == 0);
+    ASSERT(tokens[1].next == 1);
+}
+
+TEST_CASE("snapshot replay", case_snapshot_1) {
+    static unsigned char data[ARGVE_SNAPSHOT_SIZE(1024)];
+    unsigned long size;
+    argve_snapshot snapshot;
+    argve_state plain;
+    SETUP_WITH_ARGV(256);
+
+    SET_OPTION(0, 0, 'a', "a");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 'c', "c");
+    for (i = 0; i < argc; i++) {
+        argv[i] = token_args[i % (sizeof(token_args) / sizeof(char *) - 1)];
+    }
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_snapshot_save(&state, argv, data, 100) == 0);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT((size = argve_snapshot_save(&state, argv, data, sizeof(data))));
+    ASSERT(state.type == ARGVE_END);
+    ASSERT(argve_snapshot_save(&state, argv, data, sizeof(data)) == 0);
+    ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size));
+
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_init(&plain, options, argc, argv));
+    ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size - 1));
+    ASSERT(argve_snapshot_open(&snapshot, &state, argv, data, size));
+    ASSERT(snapshot.count * 28 + 36 == (int)size);
+    do {
+        type = argve_snapshot_next(&snapshot, &state);
+        ASSERT(argve_next(&plain) == type);
+        ASSERT(SAME_STATE(state, plain));
+    } while (type != ARGVE_END);
+    ASSERT(argve_snapshot_next(&snapshot, &state) == ARGVE_END);
+    ASSERT(SAME_STATE(state, plain));
+
+    /* anything changed invalidates the snapshot */
+    ASSERT(argve_init(&state, options, argc, argv));
+    for (i = 0; i < (int)size; i += 5) {
+        data[i] ^= 0x10;
+        ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size));
+        data[i] ^= 0x10;
+    }
+    argv[argc - 1] = "-a ";
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size));
+    ASSERT(argve_init(&state, options, argc - 1, argv));
+    ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size));
+    argv[argc - 1] = token_args[(argc - 1) % 20];
+    SET_OPTION(1, 0, 'b', NULL);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size));
+    SET_OPTION(1, 1, 'b', NULL);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_snapshot_open(&snapshot, &state, argv, data, size));
+
+    /* forged tokens with a valid checksum are still refused */
+    for (i = 0; i < 11; i++) {
+        /* field of the first token, value */
+        static const int forged[11][2] = {
+            { 0, 12 }, { 0, -1 }, { 1, 3 }, { 1, -2 }, { 2, -1 },
+            { 2, 257 }, { 3, 1000 }, { 3, -2 }, { 4, 257 },
+            { 5, 1000 }, { 6, 257 }
+        };
+        unsigned char *field = data + ARGVE_SNAPSHOT_SIZE(0)
+                               + 4 * forged[i][0];
+        long saved = argve_snapshot_get(field);
+
+        argve_snapshot_put(field, forged[i][1]);
+        argve_snapshot_put(data + 28, (long)argve_snapshot_hash(
+                    2166136261UL, data + ARGVE_SNAPSHOT_SIZE(0),
+                    size - ARGVE_SNAPSHOT_SIZE(0)));
+        ASSERT(!argve_snapshot_open(&snapshot, &state, argv, data, size));
+        argve_snapshot_put(field, saved);
+    }
+    argve_snapshot_put(data + 28, (long)argve_snapshot_hash(
+                2166136261UL, data + ARGVE_SNAPSHOT_SIZE(0),
+                size - ARGVE_SNAPSHOT_SIZE(0)));
+    ASSERT(argve_snapshot_open(&snapshot, &state, argv, data, size));
+}
+
+/* NOTE: variable memory not fully initialized may lead to miscompilation */
+TEST_CASE("fuzzing matchers", case_fuzzing_2) {
+    int const max_arg_size = 256;
+    int const max_flag_size = 32;
+    int rounds = 100;
+    char *memory = NULL;
+    sfc64 rng;
+    uint64_t seed = *TEST_DATA(uint64_t *);
+    argve_adaptive adaptive;
+    argve_slot slots[MAX_OPTS];
+    argve_bloom bloom;
+    unsigned char bits[MAX_OPTS * 2];
+    unsigned char kinds[256];
+    argve_index index;
+    argve_name names[MAX_OPTS];
+    unsigned long shorts[ARGVE_INDEX_WORDS(MAX_OPTS)];
+    argve_token token;
+    argve_state plain, filtered, classified, restored, indexed, dfa;
+    SETUP_WITH_ARGV(256);
+
+    sfc64_seed(&rng, seed);
+    c = argc * max_arg_size + MAX_OPTS * max_flag_size;
+    ASSERT((memory = (char *)malloc(c)) != NULL);
+
+    while (rounds-- > 0) {
+        fuzz_args(&rng, memory, c, argv, argc, options,
+                  max_arg_size, max_flag_size);
+        /* fewer distinct flags so that they do get matched */
+        for (i = 0; i < MAX_OPTS; i++) {
+            options[i].shortopt = 'a' + options[i].shortopt % 8;
+            options[i].need_arg = (i % 3 == 0);
+        }
+        for (i = 0; i < argc; i++) {
+            if ((k = sfc64_rand(&rng, 4)) == 0) {
+                argv[i][0] = '-';
+            } else if (k == 1 && argv[i][0] != '\0') {
+                argv[i][0] = argv[i][1] = '-';
+            }
+        }
+        ASSERT_OR_GOTO(argve_adaptive_init(&adaptive, options,
+                                           slots, MAX_OPTS,
+                                           1 + sfc64_rand(&rng, 64)), error);
+        ASSERT_OR_GOTO(argve_bloom_init(&bloom, options,
+                                        bits, 1 + sfc64_rand(&rng,
+                                                             sizeof(bits))),
+                       error);
+        ASSERT_OR_GOTO(argve_index_init(&index, options, names, shorts,
+                                        MAX_OPTS), error);
+        ASSERT_OR_GOTO(argve_init(&plain, options, argc, argv), error);
+        ASSERT_OR_GOTO(argve_init(&state, options, argc, argv), error);
+        ASSERT_OR_GOTO(argve_init(&filtered, options, argc, argv), error);
+        ASSERT_OR_GOTO(argve_init(&classified, options, argc, argv), error);
+        ASSERT_OR_GOTO(argve_init(&restored, options, argc, argv), error);
+        ASSERT_OR_GOTO(argve_init(&indexed, options, argc, argv), error);
+        ASSERT_OR_GOTO(argve_init(&dfa, options, argc, argv), error);
+        argve_classify(argv, argc, kinds);
+        state.adaptive = &adaptive;
+        filtered.bloom = &bloom;
+        classified.kinds = kinds;
+        indexed.index = &index;
+        do {
+            type = argve_next(&state);
+            ASSERT_OR_GOTO(argve_next(&plain) == type, error);
+            ASSERT_OR_GOTO(argve_next(&filtered) == type, error);
+            ASSERT_OR_GOTO(argve_next(&classified) == type, error);
+            ASSERT_OR_GOTO(argve_next(&indexed) == type, error);
+            ASSERT_OR_GOTO(argve_next_dfa(&dfa) == type, error);
+            ASSERT_OR_GOTO(SAME_STATE(state, plain), error);
+            ASSERT_OR_GOTO(SAME_STATE(filtered, plain), error);
+            ASSERT_OR_GOTO(SAME_STATE(classified, plain), error);
+            ASSERT_OR_GOTO(SAME_STATE(indexed, plain), error);
+            ASSERT_OR_GOTO(SAME_STATE(dfa, plain), error);
+            argve_to_token(&plain, argv, &token);
+            argve_from_token(&restored, argv, &token);
+            ASSERT_OR_GOTO(SAME_STATE(restored, plain), error);
+        } while (type != ARGVE_END);
+    }
+error:
+    free(memory);
+}
+
+TEST_CASE("fuzzing generated matchers", case_fuzzing_3) {
+    const char flags[] = "hqscovHx='\\?d9~z-=";
+    int rounds = 100;
+    sfc64 rng;
+    uint64_t seed = *TEST_DATA(uint64_t *);
+    char memory[255][32];
+    argve_state plain;
+    SETUP_WITH_ARGV(256);
+
+    sfc64_seed(&rng, seed);
+    while (rounds-- > 0) {
+        for (i = 0; i < argc; i++) {
+            argv[i] = s = memory[i];
+            j = sfc64_rand(&rng, SPEC_COUNT);
+            if ((k = sfc64_rand(&rng, 4)) == 0) {
+                /* -abc */
+                *s++ = '-';
+                for (j = sfc64_rand(&rng, 4); j >= 0; j--) {
+                    *s++ = flags[sfc64_rand(&rng, sizeof(flags) - 1)];
+                }
+                *s = '\0';
+            } else if (k == 1 || spec_options[j].longopt == NULL) {
+                sprintf(s, "%s%d", k == 1 ? "text" : "-", i);
+            } else {
+                /* --name, --name=, --name=value, --nam, --namex */
+                sprintf(s, "--%s%s", spec_options[j].longopt,
+                        k == 2 ? "" : sfc64_rand(&rng, 2) ? "=" : "=value");
+                if (sfc64_rand(&rng, 8) == 0) {
+                    s[strlen(s) - 1] = 'x';
+                }
+            }
+        }
+        ASSERT(argve_init(&plain, spec_options, argc, argv));
+        ASSERT(argve_init(&state, spec_options, argc, argv));
+        state.match_short = spec_match_short;
+        state.match_long = spec_match_long;
+        do {
+            type = argve_next(&state);
+            ASSERT(argve_next(&plain) == type);
+            ASSERT(SAME_STATE(state, plain));
+        } while (type != ARGVE_END);
+    }
+}
+
+TEST_CASE("fuzzing incremental re-parse", case_fuzzing_4) {
+    int rounds = 1000, n = sizeof(token_args) / sizeof(char *) - 1;
+    int first, count, argc2;
+    sfc64 rng;
+    uint64_t seed = *TEST_DATA(uint64_t *);
+    argve_token tokens[128], expected[128];
+    char *argv2[64];
+    SETUP_WITH_ARGV(64);
+
+    SET_OPTION(0, 0, 'a', "a");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 'c', "c");
+
+    /* a value appended to a flag missing it */
+    set_args(argv, &argc, "a", "--c", NULL);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT((count = argve_tokenize(&state, argv, tokens, 128)) == 3);
+    ASSERT(tokens[1].type == ARGVE_ERR_ARG_LONG);
+    set_args(argv, &argc, "a", "--c", "-b", NULL);
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_retokenize(&state, argv, tokens, count, 128, 4) == -1);
+    ASSERT(argve_retokenize(&state, argv, tokens, count, 128, 2) == 3);
+    ASSERT(tokens[1].type == ARGVE_LONG && tokens[1].value == 2);
+    ASSERT(tokens[2].type == ARGVE_END);
+
+    sfc64_seed(&rng, seed);
+    while (rounds-- > 0) {
+        argc = sfc64_rand(&rng, 32);
+        for (i = 0; i < argc; i++) {
+            argv[i] = token_args[sfc64_rand(&rng, n)];
+        }
+        ASSERT(argve_init(&state, options, argc, argv));
+        count = argve_tokenize(&state, argv, tokens, 128);
+        ASSERT(tokens[count - 1].type == ARGVE_END);
+
+        /* replace, insert or delete arguments from argv[first] on */
+        first = sfc64_rand(&rng, argc + 1);
+        k = sfc64_rand(&rng, 4);
+        for (i = argc2 = 0; i < first; i++) {
+            argv2[argc2++] = argv[i];
+        }
+        for (j = sfc64_rand(&rng, 4); j > 0; j--) {
+            argv2[argc2++] = token_args[sfc64_rand(&rng, n)];
+        }
+        for (i = first + (k == 0 ? 0 : (int)sfc64_rand(&rng, 4)); i < argc;
+                i++) {
+            argv2[argc2++] = argv[i];
+        }
+
+        ASSERT(argve_init(&state, options, argc2, argv2));
+        ASSERT((c = argve_tokenize(&state, argv2, expected, 128)) > 0);
+        ASSERT(argve_init(&state, options, argc2, argv2));
+        if (first > argc2) {
+            ASSERT(argve_retokenize(&state, argv2, tokens, count, 128,
+                                    first) == -1);
+            continue;
+        }
+        ASSERT(argve_retokenize(&state, argv2, tokens, count, 128,
+                                first) == c);
+        ASSERT(memcmp(tokens, expected, sizeof(argve_token) * c) == 0);
+        ASSERT(state.type == ARGVE_END && state.argc == 0);
+    }
+}
+
+TEST_CASE("argv of child processes", case_builder_1) {
+    argve_builder builder;
+    argve_token tokens[64], forwarded[64];
+    char *child[64], arena[256];
+    SETUP_WITH_ARGV(64);
+
+    ASSERT(!argve_builder_init(NULL, child, 64, arena, sizeof(arena)));
+    ASSERT(!argve_builder_init(&builder, NULL, 64, arena, sizeof(arena)));
+    ASSERT(!argve_builder_init(&builder, child, 0, arena, sizeof(arena)));
+    ASSERT(!argve_builder_init(&builder, child, 64, NULL, sizeof(arena)));
+    ASSERT(argve_builder_init(&builder, child, 64, NULL, 0));
+    ASSERT(!argve_builder_pack(&builder, "-", NULL));
+    ASSERT(argve_builder_init(&builder, child, 4, arena, 8));
+    ASSERT(builder.argc == 0 && child[0] == NULL);
+    ASSERT(!argve_builder_pack(&builder, "--name=", "value"));
+    ASSERT(builder.argc == 0 && builder.used == 0);
+    ASSERT(argve_builder_pack(&builder, "-D", "x=1"));
+    ASSERT(builder.used == 6);
+    EXPECT_STRING("-Dx=1", child[0]);
+    ASSERT(!argve_builder_append(&builder, argv, 3));
+    ASSERT(argve_builder_append(&builder, argv, 2));
+    ASSERT(builder.argc == 3 && child[1] == argv[0] && child[3] == NULL);
+    ASSERT(!argve_builder_pack(&builder, NULL, NULL));
+
+    /* forward -v and --jobs, rewrite --out, and pass the tail after -- */
+    set_args(argv, &argc, "-vq", "--jobs", "4", "--out=a.o", "-x", "--",
+             "-v", "b.c", NULL);
+    SET_OPTION(0, 0, 'v', "verbose");
+    SET_OPTION(1, 0, 'q', NULL);
+    SET_OPTION(2, 1, 'j', "jobs");
+    SET_OPTION(3, 1, 'o', "out");
+    ASSERT(argve_builder_init(&builder, child, 64, arena, sizeof(arena)));
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_builder_append(&builder, argv + 5, 0));
+    while (argve_next(&state) != ARGVE_END) {
+        argve_to_token(&state, argv, &tokens[0]);
+        if (state.type == ARGVE_TEXT && strcmp(state.argstr, "--") == 0) {
+            ASSERT(argve_builder_append(&builder, state.argv, state.argc));
+            break;
+        } else if (state.option == options + 3) {
+            ASSERT(argve_builder_pack(&builder, "--out=obj/",
+                                      state.argstr));
+        } else if (state.option != options + 1) {
+            ASSERT(argve_builder_token(&builder, argv, &tokens[0]));
+        }
+    }
+    ASSERT(builder.argc == 7 && child[7] == NULL);
+    EXPECT_STRING("-v", child[0]);
+    ASSERT(child[1] == argv[1] && child[2] == argv[2]);
+    EXPECT_STRING("--out=obj/a.o", child[3]);
+    ASSERT(child[4] == argv[4] && child[5] == argv[6]);
+    ASSERT(child[6] == argv[7]);
+    ASSERT(builder.used == 3 + 14);
+
+    /* -o- is not --, and -o-x is not --x */
+    set_args(argv, &argc, "-o-", "-o-x", "-o", NULL);
+    SET_OPTION(3, 0, 'o', "out");
+    ASSERT(argve_init(&state, options, argc, argv));
+    ASSERT(argve_tokenize(&state, argv, tokens, 64) == 6);
+    ASSERT(tokens[1].type == ARGVE_ERR_DEF_SHORT && tokens[1].optoff == 2);
+    ASSERT(tokens[3].type == ARGVE_ERR_DEF_SHORT && tokens[3].optoff == 2);
+    ASSERT(argve_builder_init(&builder, child, 64, arena, sizeof(arena)));
+    for (i = 0; i < 6; i++) {
+        ASSERT(argve_builder_token(&builder, argv, &tokens[i])
+               == (i != 1 && i != 3));
+    }
+    ASSERT(builder.argc == 3 && child[3] == NULL);
+    EXPECT_STRING("-o", child[0]);
+    EXPECT_STRING("-o", child[1]);
+    ASSERT(child[2] == argv[2]);
+
+    /* forwarding every token keeps the meaning of the arguments */
+    SET_OPTION(0, 0, 'a', "a");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 'c', "c");
+    options[3].shortopt = 0;
+    options[3].longopt = NULL;
+    for (k = 0; k < 200; k++) {
+        argc = k % 40;
+        for (i = 0; i < argc; i++) {
+            argv[i] = token_args[(i * 3 + k * 7 + i * k) % 20];
+        }
+        ASSERT(argve_init(&state, options, argc, argv));
+        c = argve_tokenize(&state, argv, tokens, 64);
+        ASSERT(argve_builder_init(&builder, child, 64, arena,
+                                  sizeof(arena)));
+        for (i = 0; i < c; i++) {
+            if (!argve_builder_token(&builder, argv, &tokens[i])) {
+                /* an unknown flag in a cluster, e.g. -ax, ends it */
+                ASSERT(tokens[i].type == ARGVE_ERR_DEF_SHORT);
+                ASSERT(tokens[i].optoff > 1);
+                tokens[i].type = ARGVE_END;
+                tokens[i].optoff = tokens[i].valoff = -1;
+                tokens[i].option = -1;
+                c = i + 1;
+            }
+        }
+        ASSERT(argve_init(&state, options, builder.argc, child));
+        ASSERT(argve_tokenize(&state, child, forwarded, 64) == c);
+        for (i = 0; i < c; i++) {
+            j = forwarded[i].type;
+            ASSERT(j == (int)tokens[i].type
+                   || (j == ARGVE_SHORT && tokens[i].type == ARGVE_CLUSTER));
+            ASSERT(forwarded[i].option == tokens[i].option);
+            ASSERT((forwarded[i].optoff < 0) == (tokens[i].optoff < 0));
+            ASSERT((forwarded[i].valoff < 0) == (tokens[i].valoff < 0));
+            if (tokens[i].valoff >= 0) {
+                EXPECT_STRING(argv[tokens[i].value] + tokens[i].valoff,
+                              child[forwarded[i].value]
+                              + forwarded[i].valoff);
+            }
+        }
+    }
+}
+
+TEST_CASE("argve_parse_many", case_many_1) {
+    static const int threads[] = {1, 3, 64, 1000};
+    static argve_token slabs[300][64], expected[64];
+    argve_result results[300];
+    argve_job jobs[300];
+    argve_index index;
+    argve_name names[3];
+    unsigned long shorts[ARGVE_INDEX_WORDS(3)];
+    char *bad[2] = {"-a", NULL};
+    int n = sizeof(token_args) / sizeof(char *) - 1, t;
+    SETUP_WITH_ARGV(64);
+
+    SET_OPTION(0, 0, 'a', "a");
+    SET_OPTION(1, 1, 'b', NULL);
+    SET_OPTION(2, 1, 'c', "c");
+    for (i = 0; i < argc; i++) {
+        argv[i] = token_args[i % n];
+    }
+    ASSERT(argve_index_init(&index, options, names, shorts, 3));
+    for (i = 0; i < 300; i++) {
+        /* the slab of every 10th job is too small */
+        jobs[i].argv = argv + i % n;
+        jobs[i].argc = i % (argc - n);
+        results[i].tokens = slabs[i];
+        results[i].size = i % 10 == 9 ? 2 : 64;
+    }
+    jobs[7].argv = bad;
+    jobs[7].argc = 2;
+    ASSERT(argve_parse_many(NULL, 300, &index, results, 1) == -1);
+    ASSERT(argve_parse_many(jobs, -1, &index, results, 1) == -1);
+    ASSERT(argve_parse_many(jobs, 300, NULL, results, 1) == -1);
+    ASSERT(argve_parse_many(jobs, 300, &index, NULL, 1) == -1);
+    ASSERT(argve_parse_many(jobs, 300, &index, results, 0) == -1);
+    ASSERT(argve_parse_many(jobs, 0, &index, results, 8) == 0);
+
+    for (t = 0; t < (int)(sizeof(threads) / sizeof(*threads)); t++) {
+        memset(slabs, 0xFF, sizeof(slabs));
+        for (i = 0; i < 300; i++) {
+            results[i].count = -2;
+        }
+        c = argve_parse_many(jobs, 300, &index, results, threads[t]);
+        ASSERT(results[7].count == -1);
+        for (i = 0; i < 300; i++) {
+            if (i == 7) {
+                continue;
+            }
+            ASSERT(argve_init(&state, options, jobs[i].argc, jobs[i].argv));
+            k = argve_tokenize(&state, jobs[i].argv, expected,
+                               results[i].size);
+            ASSERT(results[i].count == k);
+            for (j = 0; j < k; j++) {
+                ASSERT(memcmp(&slabs[i][j], &expected[j],
+                              sizeof(argve_token)) == 0);
+            }
+            c -= state.type == ARGVE_END;
+        }
+        ASSERT(c == 0);
+    }
+}
+
+TEST_CASE("bootstrap options", case_prescan_1) {
+    char *args[] = {
+        "run", "-o", "--config", "--config=a.ini", "-", "--log-level",
+        "debug", "-vhc", "b.ini", "--", "--help=x", "--conf", "-x", "-c",
+        "-hoh", "--help", "-ch", "--log-level=", "---", "-=", "--=c", NULL
+    };
+    char *found[5], *expected[5];
+    int n = sizeof(args) / sizeof(char *) - 1;
+    SETUP_WITH_ARGV(32);
+
+    set_args(argv, &argc, "run", "-o", "--config", "--config=a.ini", "-",
+             "--log-level", "debug", "-hc", "b.ini", "--", "--help=x",
+             "--conf", "-x", "--config", NULL);
+    SET_OPTION(0, 1, 'c', "config");
+    SET_OPTION(1, 1, 0, "log-level");
+    SET_OPTION(2, 0, 'h', "help");
+    SET_OPTION(3, 1, 'o', NULL);  /* only to skip its value */
+    ASSERT(argve_prescan(-1, argv, options, found) == -1);
+    ASSERT(argve_prescan(argc, NULL, options, found) == -1);
+    ASSERT(argve_prescan(argc, argv, NULL, found) == -1);
+    ASSERT(argve_prescan(argc, argv, options, NULL) == -1);
+    ASSERT(argve_prescan(argc, argv, options, found) == 5);
+    ASSERT(found[0] == argv[8]);
+    ASSERT(found[1] == argv[6]);
+    ASSERT(found[2] == argv[7] + 1);
+    ASSERT(found[3] == argv[2]);
+
+    /* the same as argve_next with the wanted options */
+    for (k = 0; k < 1000; k++) {
+        argc = k % 31;
+        for (i = 0; i < argc; i++) {
+            argv[i] = args[(i * 7 + k * 3 + i * k) % n];
+        }
+        ASSERT(argve_init(&state, options, argc, argv));
+        memset(expected, 0, sizeof(expected));
+        j = 0;
+        while (argve_next(&state) != ARGVE_END) {
+            if (state.option != NULL && !argve_error(&state)) {
+                expected[state.option - options] = state.option->need_arg
+                                                  ? state.argstr
+                                                  : state.optstr;
+                j += 1;
+            }
+        }
+        ASSERT(argve_prescan(argc, argv, options, found) == j);
+        ASSERT(memcmp(found, expected, sizeof(char *) * 4) == 0);
+    }
+}
+
+/* a typical command line for the benchmarks of the hot paths */
+#define SETUP_BENCH() \
+    SETUP_WITH_ARGV(32); \
+    SET_OPTION(0, 0, 'v', "verbose"); \
+    SET_OPTION(1, 1, 'o', "output"); \
+    SET_OPTION(2, 0, 'q', "quiet"); \
+    SET_OPTION(3, 1, 'I', "include"); \
+    SET_OPTION(4, 1, 'D', "define"); \
+    SET_OPTION(5, 0, 0, "no-color"); \
+    SET_OPTION(6, 1, 0, "jobs"); \
+    SET_OPTION(7, 0, 'h', "help"); \
+    set_args(argv, &argc, "-vq", "--output=a.out", "-Iinclude", "-I", \
+             "src", "--define", "X=1", "--no-color", "--jobs", "8", \
+             "main.c", "--", "-h", "--include", "lib", "util.c", NULL)
+
+BENCH_CASE("argve_next", bench_next) {
+    SETUP_BENCH();
+
+    k = 0;
+    BENCH {
+        ASSERT(argve_init(&state, options, argc, argv));
+        while (argve_next(&state) != ARGVE_END) {
+            k += 1;
+        }
+        BENCH_KEEP(k);
+    }
+    ASSERT(k > 0);
+}
+
+BENCH_CASE("argve_next_dfa", bench_next_dfa) {
+    SETUP_BENCH();
+
+    k = 0;
+    BENCH {
+        ASSERT(argve_init(&state, options, argc, argv));
+        while (argve_next_dfa(&state) != ARGVE_END) {
+            k += 1;
+        }
+        BENCH_KEEP(k);
+    }
+    ASSERT(k > 0);
+}
+
+BENCH_CASE("argve_tokenize", bench_tokenize) {
+    argve_token tokens[64];
+    SETUP_BENCH();
+
+    k = 0;
+    BENCH {
+        ASSERT(argve_init(&state, options, argc, argv));
+        k += argve_tokenize(&state, argv, tokens, 64);
+        BENCH_KEEP(k);
+    }
+    ASSERT(k > 0);
+}
+
+BENCH_CASE("argve_suggest", bench_suggest) {
+    argve_suggestion found[1];
+    SETUP_BENCH();
+
+    k = 0;
+    BENCH {
+        k += argve_suggest(options, "includ", found, 1);
+        BENCH_KEEP(k);
+    }
+    ASSERT(k > 0);
+}
+
 TEST_SUITE("argve_init", suite_init) {
     TEST(case_init_1, NULL);
     TEST(case_init_2, NULL);
@@ -884,8 +2365,77 @@ TEST_SUITE("dashes", suite_dashes) {
     TEST(case_dashes_2, NULL);
 }
 
+TEST_SUITE("adaptive", suite_adaptive) {
+    TEST(case_adaptive_1, NULL);
+    TEST(case_adaptive_2, NULL);
+    TEST(case_adaptive_3, NULL);
+}
+
+TEST_SUITE("bloom", suite_bloom) {
+    TEST(case_bloom_1, NULL);
+    TEST(case_bloom_2, NULL);
+}
+
+TEST_SUITE("index", suite_index) {
+    TEST(case_index_1, NULL);
+    TEST(case_index_2, NULL);
+}
+
+TEST_SUITE("dfa", suite_dfa) {
+    TEST(case_dfa_1, NULL);
+}
+
+TEST_SUITE("hooks", suite_hooks) {
+    TEST(case_hooks_1, NULL);
+}
+
+TEST_SUITE("choices", suite_choices) {
+    TEST(case_choices_1, NULL);
+    TEST(case_choices_2, NULL);
+}
+
+TEST_SUITE("pairs", suite_pairs) {
+    TEST(case_pairs_1, NULL);
+    TEST(case_pairs_2, NULL);
+}
+
+TEST_SUITE("suggest", suite_suggest) {
+    TEST(case_suggest_1, NULL);
+}
+
+TEST_SUITE("run", suite_run) {
+    TEST(case_run_1, NULL);
+}
+
+TEST_SUITE("kinds", suite_kinds) {
+    TEST(case_kinds_1, NULL);
+    TEST(case_kinds_2, NULL);
+}
+
+TEST_SUITE("prescan", suite_prescan) {
+    TEST(case_prescan_1, NULL);
+}
+
+TEST_SUITE("tokens", suite_tokens) {
+    TEST(case_tokens_1, NULL);
+    TEST(case_snapshot_1, NULL);
+    TEST(case_builder_1, NULL);
+    TEST(case_many_1, NULL);
+}
+
 TEST_SUITE("fuzzing", suite_fuzzing) {
     TEST(case_fuzzing_1, TEST_DATA(uint64_t *));
+    TEST(case_fuzzing_2, TEST_DATA(uint64_t *));
+    TEST(case_fuzzing_3, TEST_DATA(uint64_t *));
+    TEST(case_fuzzing_4, TEST_DATA(uint64_t *));
+    TEST(case_fuzzing_5, TEST_DATA(uint64_t *));
+}
+
+TEST_SUITE("bench", suite_bench) {
+    TEST(bench_next, NULL);
+    TEST(bench_next_dfa, NULL);
+    TEST(bench_tokenize, NULL);
+    TEST(bench_suggest, NULL);
 }
 
 TEST_MAIN {
@@ -905,11 +2455,27 @@ TEST_MAIN {
         n = sizeof(time_t) - sizeof(suseconds_t);
         seed = tv.tv_sec ^ ((time_t)tv.tv_usec << n * 8);
     }
-    fprintf(stdout, "[INFO] SEED = %" PRIu64 "\n", seed);
+    /* not mixed into the records of --format or --list */
+    fprintf(test_h_globaldata->format == TEST_H_FORMAT_TEXT
+            && !test_h_globaldata->list ? stdout : stderr,
+            "[INFO] SEED = %" PRIu64 "\n", seed);
 
     RUN(suite_init, NULL);
     RUN(suite_positional, NULL);
     RUN(suite_options, NULL);
     RUN(suite_dashes, NULL);
+    RUN(suite_adaptive, NULL);
+    RUN(suite_bloom, NULL);
+    RUN(suite_index, NULL);
+    RUN(suite_dfa, NULL);
+    RUN(suite_hooks, NULL);
+    RUN(suite_choices, NULL);
+    RUN(suite_pairs, NULL);
+    RUN(suite_suggest, NULL);
+    RUN(suite_run, NULL);
+    RUN(suite_kinds, NULL);
+    RUN(suite_prescan, NULL);
+    RUN(suite_tokens, NULL);
     RUN(suite_fuzzing, &seed);
+    RUN(suite_bench, NULL);
 }
@@ -1,3 +1,7 @@
+#if defined(__linux__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime in test.h */
+#endif
+
 #include <argve.h>
 
 #define TEST_MAIN
@@ -10,65 +14,40 @@
 
 static void test_h_main(test_h_globaldata_t *test_h_globaldata);
 
-#include <sys/time.h>
-
-#ifndef timersub
-#define timersub(a, b, t) \
-    do { \
-        (t)->tv_sec = (a)->tv_sec - (b)->tv_sec; \
-        (t)->tv_usec = (a)->tv_usec - (b)->tv_usec; \
-        if ((t)->tv_usec < 0) { \
-            (t)->tv_sec--; \
-            (t)->tv_usec += 1000000; \
-        } \
-    } while (0)
-#endif /* timersub */
-
-static void
-test_h_help(FILE *stream)
-{
-    fprintf(stream, "%s", TEST_H_HELP);
-}
-
-static test_h_filter_t *
-test_h_add_filter(test_h_filter_t *filter,
-                  const char *suite,
-                  const char *test)
-{
-    if (suite != NULL || test != NULL) {
-        filter->next = (test_h_filter_t *)malloc(sizeof(test_h_filter_t));
-        filter = filter->next;
-        if (filter != NULL) {
-            filter->suite = suite;
-            filter->test = test;
-            filter->next = NULL;
-        } else {
-            fprintf(stderr, "\n[ERROR] failed to allocate memory\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    return filter;
-}
-
 int main(int argc, char **argv)
 {
     test_h_globaldata_t data;
     test_h_filter_t *filter;
     int c = 0, dashdash = 0;
     const char *suite = NULL;
-    struct timeval time_start, time_end, time_used;
+    test_h_stats_t time_used;
 
     argve_option options[] = {
         {0, 'h', "help"},
         {0, 'q', "quiet"},
         {1, 's', "suite"},
         {1, 'c', "case"},
+        {1, 'x', "exclude"},
+        {1, 'j', "jobs"},
+        {0, 'i', "isolate"},
+        {1, 't', "timeout"},
+        {1, 0, "shard-index"},
+        {1, 0, "shard-count"},
+        {0, 'd', "durations"},
+        {1, 'S', "slowest"},
+        {1, 'f', "format"},
+        {0, 'l', "list"},
+        {0, 'b', "bench"},
+        {1, 0, "bench-time"},
+        {1, 0, "pin"},
+        {0, 0, "fifo"},
         {0, 0, NULL}
     };
     argve_state state;
 
     memset(&data, 0, sizeof(data));
     filter = &data.filter;
+    data.bench_time = 300;
 
     if (!argve_init(&state, options, argc - 1, argv + 1)) {
         TEST_H_ERROR_EXIT(argve_init);
@@ -79,6 +58,12 @@ int main(int argc, char **argv)
             argve_perror(&state, "\n[ERROR] ", stderr);
             exit(EXIT_FAILURE);
         }
+        if (c == 's' && (state.type == ARGVE_TEXT
+                         || (state.option->shortopt != 's'
+                             && state.option->shortopt != 'c'))) {
+            /* -s <suite> followed by neither --case nor --suite */
+            filter = test_h_add_filter(filter, suite, NULL);
+        }
         if (state.type == ARGVE_TEXT) {
             if (dashdash || !(dashdash = test_h_str_eq("--", state.argstr))) {
                 fprintf(stderr, "\n[ERROR] unexpected argument#%d: %s\n",
@@ -104,6 +89,55 @@ int main(int argc, char **argv)
             case 'c':
                 filter = test_h_add_filter(filter, suite, state.argstr);
                 break;
+            case 'x':
+                test_h_add_exclude(filter, state.argstr);
+                break;
+            case 'j':
+                data.jobs = test_h_number("--jobs", state.argstr, 1, 1024);
+                break;
+            case 'i':
+                data.isolate = 1;
+                break;
+            case 't':
+                data.timeout = test_h_number("--timeout", state.argstr,
+                                             0, 86400);
+                data.isolate = 1;
+                break;
+            case 'd':
+                data.durations = 1;
+                break;
+            case 'S':
+                data.slowest = test_h_number("--slowest", state.argstr,
+                                             0, 1 << 30);
+                break;
+            case 'f':
+                data.format = test_h_format("--format", state.argstr);
+                break;
+            case 'l':
+                data.list = 1;
+                break;
+            case 'b':
+                data.bench = 1;
+                break;
+            case 0:
+                if (test_h_str_eq("fifo", state.option->longopt)) {
+                    data.fifo = 1;
+                } else if (test_h_str_eq("shard-index",
+                                         state.option->longopt)) {
+                    data.shard = test_h_number("--shard-index",
+                                               state.argstr, 0, 65535);
+                } else if (test_h_str_eq("shard-count",
+                                         state.option->longopt)) {
+                    data.shards = test_h_number("--shard-count",
+                                                state.argstr, 1, 65536);
+                } else if (test_h_str_eq("pin", state.option->longopt)) {
+                    data.pin = 1 + test_h_number("--pin",
+                                                 state.argstr, 0, 1023);
+                } else {
+                    data.bench_time = test_h_number("--bench-time",
+                                                    state.argstr, 1, 3600000);
+                }
+                break;
             default:
                 TEST_H_ERROR_EXIT(argve_next);
             }
@@ -117,29 +151,29 @@ int main(int argc, char **argv)
         }
     }
 
-    if (!data.silent) {
-        printf("[INFO] Tests starting...\n");
-        if (gettimeofday(&time_start, NULL) != 0) {
-            TEST_H_ERROR_EXIT(gettimeofday);
-        }
+    if (data.shard > 0 && data.shard >= data.shards) {
+        test_h_help(stderr);
+        fprintf(stderr, "\n[ERROR] no shard #%d of %d\n",
+                data.shard, data.shards);
+        exit(EXIT_FAILURE);
     }
+    if (data.list) {
+#ifdef TEST_H_AUTO
+        test_h_list_all(&data);
+#else
+        test_h_main(&data);
+#endif
+        return EXIT_SUCCESS;
+    }
+    test_h_begin(&data);
+    test_h_usage(&time_used);
 
     test_h_main(&data);
+    test_h_join(&data);
 
-    if (!data.silent) {
-        if (gettimeofday(&time_end, NULL) != 0) {
-            TEST_H_ERROR_EXIT(gettimeofday);
-        }
-        timersub(&time_end, &time_start, &time_used);
-        printf("[INFO] Total / Passed / Failed: %d / %d / %d\n",
-                data.total,
-                data.passed,
-                data.failed);
-        printf("[INFO] Time used: %ld minutes %ld.%06ld seconds\n",
-                time_used.tv_sec / 60,
-                time_used.tv_sec % 60,
-                (time_t)time_used.tv_usec);
-    }
+    test_h_since(&time_used);
+    test_h_end(&data, time_used.wall);
+    test_h_report_slowest(&data);
 
     return data.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,409 @@
+/*\
+ / argvegen -- generate specialized matchers of options for argve.h
+ /
+ / Usage: argvegen [-p <prefix>] [-o <output>] [<spec>]
+ /
+ / Every line of a spec is either empty, a comment starting with '#', or
+ /
+ /     <id> <short> <long> <need_arg>
+ /
+ / where <id> is a C identifier, <short> is a visible ASCII character except
+ / for '-', a virtual code of two or more digits, or '-' for none, <long> is
+ / the name of a long flag or '-' for none, and <need_arg> is 0 or 1.
+ /
+ / The output is C code to be included after argve.h, defining for a prefix
+ / "opts" an enumeration OPTS_<id>... OPTS_COUNT of the options in order,
+ / the table opts_options, a switch-based opts_match_short and a perfect hash
+ / opts_match_long.  The matchers behave exactly like argve_match_short and
+ / argve_match_long on the table, so they can be plugged into argve_next by
+ / state.match_short and state.match_long with ARGVE_H_WITH_HOOKS.
+\*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARGVE_H_WITH_IMPLEMENTATION
+#define ARGVE_H_API static
+#include <argve.h>
+
+#define MAX_SPECS 4096
+#define MAX_NAME 255
+#define MAX_LINE 1024
+#define MAX_TRIES 10000
+
+#define HELP \
+    "Usage: argvegen [options] [<spec>]\n" \
+    "\n" \
+    "Options:\n" \
+    "    -h, --help             Show this help information.\n" \
+    "    -p, --prefix <name>    Prefix of generated names. (default: opts)\n" \
+    "    -o, --output <file>    Write to <file> instead of stdout.\n"
+
+typedef struct {
+    char id[MAX_NAME + 1];
+    char longopt[MAX_NAME + 1];  /* "" for none */
+    int shortopt;                /* 0 for none */
+    int need_arg;
+    int shadowed;                /* long flag of an earlier option */
+} spec_t;
+
+static spec_t specs[MAX_SPECS];
+static int nspecs = 0;
+
+static int is_identifier(const char *s)
+{
+    if (!(*s == '_' || (*s >= 'A' && *s <= 'Z')
+            || (*s >= 'a' && *s <= 'z'))) {
+        return 0;
+    }
+    for (s += 1; *s != '\0'; s += 1) {
+        if (!(*s == '_' || (*s >= 'A' && *s <= 'Z')
+                || (*s >= 'a' && *s <= 'z') || (*s >= '0' && *s <= '9'))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* return the short flag or virtual code in <s>, 0 for none, -1 if invalid */
+static int to_short(const char *s)
+{
+    long n = 0;
+
+    if (strcmp(s, "-") == 0) {
+        return 0;
+    }
+    if (s[1] == '\0') {
+        return argve_to_short_opt(s[0]) ? (unsigned char)s[0] : -1;
+    }
+    for (; *s >= '0' && *s <= '9' && n < 0x7FFF; s += 1) {
+        n = n * 10 + (*s - '0');
+    }
+    return (*s == '\0' && n > 0 && n < 0x7FFF) ? (int)n : -1;
+}
+
+static void fail(const char *path, int line, const char *message)
+{
+    fprintf(stderr, "argvegen: %s:%d: %s\n", path, line, message);
+    exit(EXIT_FAILURE);
+}
+
+static void read_specs(FILE *in, const char *path)
+{
+    char line[MAX_LINE + 1], id[MAX_LINE + 1], shortopt[MAX_LINE + 1],
+         longopt[MAX_LINE + 1], need_arg[MAX_LINE + 1], extra[2];
+    spec_t *spec;
+    int i, n, lineno = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineno += 1;
+        if (strchr(line, '\n') == NULL && !feof(in)) {
+            fail(path, lineno, "line too long");
+        }
+        n = sscanf(line, "%s %s %s %s %1s",
+                   id, shortopt, longopt, need_arg, extra);
+        if (n <= 0 || id[0] == '#') {
+            continue;
+        }
+        if (n != 4) {
+            fail(path, lineno, "expected <id> <short> <long> <need_arg>");
+        }
+        if (nspecs == MAX_SPECS) {
+            fail(path, lineno, "too many options");
+        }
+        spec = &specs[nspecs];
+        if (strlen(id) > MAX_NAME || !is_identifier(id)) {
+            fail(path, lineno, "invalid identifier");
+        }
+        for (i = 0; i < nspecs; i++) {
+            if (strcmp(specs[i].id, id) == 0) {
+                fail(path, lineno, "duplicate identifier");
+            }
+        }
+        if ((spec->shortopt = to_short(shortopt)) < 0) {
+            fail(path, lineno, "invalid short flag");
+        }
+        if (strcmp(longopt, "-") == 0) {
+            longopt[0] = '\0';
+        } else if (strlen(longopt) > MAX_NAME
+                   || argve_to_long_opt(longopt, 0) == NULL) {
+            fail(path, lineno, "invalid long flag");
+        }
+        if (spec->shortopt == 0 && longopt[0] == '\0') {
+            fail(path, lineno, "neither short nor long flag");
+        }
+        if (strcmp(need_arg, "0") != 0 && strcmp(need_arg, "1") != 0) {
+            fail(path, lineno, "need_arg is neither 0 nor 1");
+        }
+        strcpy(spec->id, id);
+        strcpy(spec->longopt, longopt);
+        spec->need_arg = need_arg[0] == '1';
+        spec->shadowed = 0;
+        for (i = 0; i < nspecs && longopt[0] != '\0'; i++) {
+            if (strcmp(specs[i].longopt, longopt) == 0) {
+                spec->shadowed = 1;
+            }
+        }
+        nspecs += 1;
+    }
+    if (ferror(in)) {
+        fail(path, lineno, "failed to read");
+    }
+}
+
+/*\
+ / FNV-1a over the name up to '=', the same as the generated code.
+ /
+ / The low bits of FNV-1a only depend on the low bits of the input and the
+ / seed, so the high bits are folded in before masking.
+\*/
+static unsigned long hash(unsigned long seed, const char *s)
+{
+    unsigned long h = seed;
+
+    for (; *s != '\0' && *s != '='; s += 1) {
+        h = ((h ^ (unsigned char)*s) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return h ^ (h >> 15);
+}
+
+/* find a seed of <hash> without collisions, filling <slots> of <*size> */
+static unsigned long find_seed(short *slots, unsigned long *size,
+                               unsigned long max_size)
+{
+    unsigned long seed, mask, k, h;
+    int i, n = 0;
+
+    for (i = 0; i < nspecs; i++) {
+        n += specs[i].longopt[0] != '\0' && !specs[i].shadowed;
+    }
+    for (*size = 1; *size < (unsigned long)n; *size *= 2) {
+        /* nothing */
+    }
+    for (; *size <= max_size; *size *= 2) {
+        mask = *size - 1;
+        for (k = 0; k < MAX_TRIES; k++) {
+            seed = (2166136261UL ^ (k * 0x9E3779B9UL)) & 0xFFFFFFFFUL;
+            for (h = 0; h < *size; h++) {
+                slots[h] = -1;
+            }
+            for (i = 0; i < nspecs; i++) {
+                if (specs[i].longopt[0] == '\0' || specs[i].shadowed) {
+                    continue;
+                }
+                h = hash(seed, specs[i].longopt) & mask;
+                if (slots[h] >= 0) {
+                    break;
+                }
+                slots[h] = (short)i;
+            }
+            if (i == nspecs) {
+                return seed;
+            }
+        }
+    }
+    fprintf(stderr, "argvegen: failed to find a perfect hash\n");
+    exit(EXIT_FAILURE);
+}
+
+static void write_short(FILE *out, int c)
+{
+    if (c == '\'' || c == '\\') {
+        fprintf(out, "'\\%c'", c);
+    } else if (c > 0x20 && c < 0x7F) {
+        fprintf(out, "'%c'", c);
+    } else {
+        fprintf(out, "%d", c);
+    }
+}
+
+/* write <s> as a C string literal, escaping '?' for trigraphs */
+static void write_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s != '\0'; s += 1) {
+        if (*s == '"' || *s == '\\' || *s == '?') {
+            fputc('\\', out);
+        }
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_code(FILE *out, const char *path, const char *prefix)
+{
+    static short slots[MAX_SPECS * 8];
+    char upper[MAX_NAME + 1];
+    unsigned long seed, size, h;
+    int i, j;
+
+    for (i = 0; prefix[i] != '\0'; i++) {
+        upper[i] = (prefix[i] >= 'a' && prefix[i] <= 'z')
+                 ? prefix[i] - 'a' + 'A' : prefix[i];
+    }
+    upper[i] = '\0';
+    seed = find_seed(slots, &size, sizeof(slots) / sizeof(*slots));
+
+    fprintf(out, "/* generated by argvegen from %s; do not edit */\n\n",
+            path);
+    fprintf(out, "#include <argve.h>\n\n");
+
+    fprintf(out, "enum {\n");
+    for (i = 0; i < nspecs; i++) {
+        fprintf(out, "    %s_%s,\n", upper, specs[i].id);
+    }
+    fprintf(out, "    %s_COUNT\n};\n\n", upper);
+
+    fprintf(out, "static argve_option %s_options[%s_COUNT + 1] = {\n",
+            prefix, upper);
+    for (i = 0; i < nspecs; i++) {
+        fprintf(out, "    {%d, ", specs[i].need_arg);
+        write_short(out, specs[i].shortopt);
+        if (specs[i].longopt[0] != '\0') {
+            fprintf(out, ", ");
+            write_string(out, specs[i].longopt);
+            fprintf(out, "},\n");
+        } else {
+            fprintf(out, ", NULL},\n");
+        }
+    }
+    fprintf(out, "    {0, 0, NULL}\n};\n\n");
+
+    fprintf(out,
+            "static argve_option * %s_match_short(const argve_option *opts,"
+            "\n", prefix);
+    fprintf(out, "%*sint c)\n{\n", (int)strlen(prefix) + 35, "");
+    fprintf(out, "    if (opts == NULL) {\n        return NULL;\n    }\n");
+    fprintf(out, "    switch (c) {\n");
+    for (i = 0; i < nspecs; i++) {
+        if (specs[i].shortopt == 0) {
+            continue;
+        }
+        for (j = 0; j < i && specs[j].shortopt != specs[i].shortopt; j++) {
+            /* nothing */
+        }
+        if (j == i) {
+            fprintf(out, "    case ");
+            write_short(out, specs[i].shortopt);
+            fprintf(out, ":\n        return (argve_option *)opts + %s_%s;\n",
+                    upper, specs[i].id);
+        }
+    }
+    fprintf(out, "    default:\n        return NULL;\n    }\n}\n\n");
+
+    fprintf(out,
+            "static argve_option * %s_match_long(const argve_option *opts,"
+            "\n", prefix);
+    fprintf(out, "%*sconst char *s)\n{\n", (int)strlen(prefix) + 34, "");
+    fprintf(out, "    static const short slots[%lu] = {", size);
+    for (h = 0; h < size; h++) {
+        fprintf(out, "%s%d", h % 12 == 0 ? "\n        " : " ",
+                (int)slots[h]);
+        if (h + 1 < size) {
+            fprintf(out, ",");
+        }
+    }
+    fprintf(out, "\n    };\n");
+    fprintf(out, "    static const char *const names[%s_COUNT + 1] = {\n",
+            upper);
+    for (i = 0; i < nspecs; i++) {
+        if (specs[i].longopt[0] != '\0') {
+            fprintf(out, "        ");
+            write_string(out, specs[i].longopt);
+            fprintf(out, ",\n");
+        } else {
+            fprintf(out, "        NULL,\n");
+        }
+    }
+    fprintf(out, "        NULL\n    };\n");
+    fprintf(out, "    unsigned long h = 0x%08lXUL;\n", seed);
+    fprintf(out, "    const char *p, *q;\n    int i;\n\n");
+    fprintf(out,
+            "    if (opts == NULL || s == NULL || s[0] != '-' "
+            "|| s[1] != '-') {\n        return NULL;\n    }\n");
+    fprintf(out,
+            "    for (p = s + 2; *p != '\\0' && *p != '='; p += 1) {\n"
+            "        h = ((h ^ (unsigned char)*p) * 16777619UL)"
+            " & 0xFFFFFFFFUL;\n    }\n");
+    fprintf(out,
+            "    if ((i = slots[(h ^ (h >> 15)) & %luUL]) < 0) {\n"
+            "        return NULL;\n    }\n", size - 1);
+    fprintf(out,
+            "    for (p = s + 2, q = names[i]; *q != '\\0' && *p == *q;"
+            " p += 1) {\n        q += 1;\n    }\n");
+    fprintf(out,
+            "    if (*q != '\\0' || (*p != '\\0' && *p != '=')) {\n"
+            "        return NULL;\n    }\n");
+    fprintf(out, "    return (argve_option *)opts + i;\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+    argve_option options[] = {
+        {0, 'h', "help"},
+        {1, 'p', "prefix"},
+        {1, 'o', "output"},
+        {0, 0, NULL}
+    };
+    argve_state state;
+    const char *prefix = "opts", *output = NULL, *path = NULL;
+    FILE *in = stdin, *out = stdout;
+
+    if (!argve_init(&state, options, argc - 1, argv + 1)) {
+        fprintf(stderr, "argvegen: invalid arguments\n");
+        return EXIT_FAILURE;
+    }
+    while (argve_next(&state) != ARGVE_END) {
+        if (argve_error(&state)) {
+            argve_perror(&state, "argvegen: ", stderr);
+            return EXIT_FAILURE;
+        }
+        if (state.type == ARGVE_TEXT) {
+            if (path != NULL) {
+                fprintf(stderr, "argvegen: more than one spec\n");
+                return EXIT_FAILURE;
+            }
+            path = state.argstr;
+        } else if (state.option->shortopt == 'h') {
+            printf("%s", HELP);
+            return EXIT_SUCCESS;
+        } else if (state.option->shortopt == 'p') {
+            prefix = state.argstr;
+        } else {
+            output = state.argstr;
+        }
+    }
+    if (strlen(prefix) > MAX_NAME || !is_identifier(prefix)) {
+        fprintf(stderr, "argvegen: invalid prefix: %s\n", prefix);
+        return EXIT_FAILURE;
+    }
+
+    if (path != NULL && strcmp(path, "-") != 0) {
+        if ((in = fopen(path, "r")) == NULL) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+    } else {
+        path = "<stdin>";
+    }
+    read_specs(in, path);
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    if (output != NULL && (out = fopen(output, "w")) == NULL) {
+        perror(output);
+        return EXIT_FAILURE;
+    }
+    write_code(out, path, prefix);
+    if (fflush(out) != 0 || ferror(out)) {
+        perror(output != NULL ? output : "stdout");
+        return EXIT_FAILURE;
+    }
+    if (out != stdout && fclose(out) != 0) {
+        perror(output);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}